@@ -0,0 +1,442 @@
+/*
+
+SDL_composite.c: alpha compositing kernels for SDL surfaces
+
+The kernels work on 32 bit pixels with 8 bits per channel and treat all four
+channels alike, so the alpha channel of the destination is composited the
+same way as the colors. They use SSE2 or NEON when the compiler enables them.
+The plain C loops are the reference, and the vector code gives the same
+results bit for bit.
+
+*/
+
+#include <stddef.h>
+#include <string.h>
+
+#include "SDL_composite.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define COMPOSITE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define COMPOSITE_NEON 1
+#endif
+
+/*!
+\brief Number of pixels a rotated blit gathers from a source column at a time.
+*/
+#define COMPOSITE_GATHER 64
+
+/*!
+\brief Selects the vector kernels, cleared to run the C reference kernels only.
+*/
+static int _useVectorKernels = 1;
+
+/*!
+\brief Internal product of two 8 bit values divided by 255, rounded to nearest.
+*/
+static Uint32 _mul255(Uint32 a, Uint32 b)
+{
+	Uint32 t = a * b + 128;
+	return (t + (t >> 8)) >> 8;
+}
+
+/*!
+\brief Internal scaling of all four channels of a pixel by k/255.
+*/
+static Uint32 _scalePixel(Uint32 p, Uint32 k)
+{
+	return _mul255(p & 0xff, k) |
+		(_mul255((p >> 8) & 0xff, k) << 8) |
+		(_mul255((p >> 16) & 0xff, k) << 16) |
+		(_mul255(p >> 24, k) << 24);
+}
+
+/*!
+\brief Internal channel-wise sum of two pixels, saturated at 255.
+*/
+static Uint32 _addPixels(Uint32 a, Uint32 b)
+{
+	Uint32 sum = 0;
+	int shift;
+
+	for (shift = 0; shift < 32; shift += 8) {
+		Uint32 c = ((a >> shift) & 0xff) + ((b >> shift) & 0xff);
+		sum |= (c > 0xff ? 0xff : c) << shift;
+	}
+	return sum;
+}
+
+#if defined(COMPOSITE_SSE2)
+/*!
+\brief Internal division of 16 bit products by 255, the same rounding as _mul255.
+*/
+static __m128i _div255Sse2(__m128i p)
+{
+	__m128i t = _mm_add_epi16(p, _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+/*!
+\brief Internal scaling of the channels of four pixels by 16 bit factors.
+
+\param p The four pixels.
+\param klo The factors of the channels of the first two pixels.
+\param khi The factors of the channels of the last two pixels.
+*/
+static __m128i _scalePixelsSse2(__m128i p, __m128i klo, __m128i khi)
+{
+	__m128i zero = _mm_setzero_si128();
+	__m128i lo = _div255Sse2(_mm_mullo_epi16(_mm_unpacklo_epi8(p, zero), klo));
+	__m128i hi = _div255Sse2(_mm_mullo_epi16(_mm_unpackhi_epi8(p, zero), khi));
+	return _mm_packus_epi16(lo, hi);
+}
+#elif defined(COMPOSITE_NEON)
+/*!
+\brief Internal division of 16 bit products by 255, the same rounding as _mul255.
+*/
+static uint8x8_t _div255Neon(uint16x8_t p)
+{
+	return vraddhn_u16(p, vrshrq_n_u16(p, 8));
+}
+#endif
+
+/*!
+\brief Internal blend of a row with a constant color.
+
+\param dst Pointer to the first pixel of the row.
+\param width Number of pixels in the row.
+\param color The color, already scaled by its opacity.
+\param inverse The remaining opacity of the destination, 255 minus the opacity of the color.
+*/
+static void _fillBlendRow(Uint32 *dst, int width, Uint32 color, Uint32 inverse)
+{
+	int x = 0;
+
+#if defined(COMPOSITE_SSE2)
+	if (_useVectorKernels) {
+		__m128i vcolor = _mm_set1_epi32((int) color);
+		__m128i vinverse = _mm_set1_epi16((short) inverse);
+		for (; x + 4 <= width; x += 4) {
+			__m128i d = _scalePixelsSse2(_mm_loadu_si128((const __m128i *) (dst + x)), vinverse, vinverse);
+			_mm_storeu_si128((__m128i *) (dst + x), _mm_adds_epu8(d, vcolor));
+		}
+	}
+#elif defined(COMPOSITE_NEON)
+	if (_useVectorKernels) {
+		uint8x16_t vcolor = vreinterpretq_u8_u32(vdupq_n_u32(color));
+		uint8x8_t vinverse = vdup_n_u8((Uint8) inverse);
+		for (; x + 4 <= width; x += 4) {
+			uint8x16_t d = vreinterpretq_u8_u32(vld1q_u32(dst + x));
+			d = vcombine_u8(_div255Neon(vmull_u8(vget_low_u8(d), vinverse)),
+				_div255Neon(vmull_u8(vget_high_u8(d), vinverse)));
+			vst1q_u32(dst + x, vreinterpretq_u32_u8(vqaddq_u8(d, vcolor)));
+		}
+	}
+#endif
+
+	for (; x < width; x++) {
+		dst[x] = _addPixels(color, _scalePixel(dst[x], inverse));
+	}
+}
+
+/*!
+\brief Internal blend of a row of premultiplied pixels over a row.
+
+Source pixels are scaled by the opacity first, each destination pixel then
+keeps the part not covered by the scaled source pixel.
+
+\param src Pointer to the first source pixel of the row.
+\param dst Pointer to the first destination pixel of the row.
+\param width Number of pixels in the row.
+\param alpha The opacity of the source row.
+\param ashift The bit position of alpha in the pixels.
+*/
+static void _blendRowPremultiplied(const Uint32 *src, Uint32 *dst, int width, Uint32 alpha, int ashift)
+{
+	int x = 0;
+
+#if defined(COMPOSITE_SSE2)
+	if (_useVectorKernels) {
+		__m128i valpha = _mm_set1_epi16((short) alpha);
+		__m128i amask = _mm_set1_epi32(0xff);
+		__m128i vashift = _mm_cvtsi32_si128(ashift);
+		for (; x + 4 <= width; x += 4) {
+			__m128i s = _mm_loadu_si128((const __m128i *) (src + x));
+			__m128i d = _mm_loadu_si128((const __m128i *) (dst + x));
+			__m128i inverse;
+			if (alpha != 255) {
+				s = _scalePixelsSse2(s, valpha, valpha);
+			}
+			/* 255 minus source alpha, repeated for the four channels of each pixel */
+			inverse = _mm_xor_si128(_mm_and_si128(_mm_srl_epi32(s, vashift), amask), amask);
+			inverse = _mm_or_si128(inverse, _mm_slli_epi32(inverse, 16));
+			d = _scalePixelsSse2(d, _mm_unpacklo_epi32(inverse, inverse), _mm_unpackhi_epi32(inverse, inverse));
+			_mm_storeu_si128((__m128i *) (dst + x), _mm_adds_epu8(s, d));
+		}
+	}
+#elif defined(COMPOSITE_NEON)
+	if (_useVectorKernels) {
+		uint8x8_t valpha = vdup_n_u8((Uint8) alpha);
+		int aindex = ashift / 8;
+		for (; x + 8 <= width; x += 8) {
+			/* channels of eight pixels in separate registers */
+			uint8x8x4_t s = vld4_u8((const uint8_t *) (src + x));
+			uint8x8x4_t d = vld4_u8((const uint8_t *) (dst + x));
+			uint8x8_t inverse;
+			int c;
+			if (alpha != 255) {
+				for (c = 0; c < 4; c++) {
+					s.val[c] = _div255Neon(vmull_u8(s.val[c], valpha));
+				}
+			}
+			inverse = vmvn_u8(s.val[aindex]);
+			for (c = 0; c < 4; c++) {
+				d.val[c] = vqadd_u8(s.val[c], _div255Neon(vmull_u8(d.val[c], inverse)));
+			}
+			vst4_u8((uint8_t *) (dst + x), d);
+		}
+	}
+#endif
+
+	for (; x < width; x++) {
+		Uint32 s = alpha == 255 ? src[x] : _scalePixel(src[x], alpha);
+		if (s == 0) {
+			continue;
+		}
+		dst[x] = _addPixels(s, _scalePixel(dst[x], 255 - ((s >> ashift) & 0xff)));
+	}
+}
+
+/*!
+\brief Internal check of the pixel format of a 32 bit compositing destination.
+*/
+static int _isCompositeTarget(const SDL_Surface * dst)
+{
+	const SDL_PixelFormat *format = dst->format;
+	return format->BitsPerPixel == 32 &&
+		format->Rloss == 0 && format->Gloss == 0 && format->Bloss == 0;
+}
+
+/*!
+\brief Enables or disables the vector kernels.
+
+With the vector kernels disabled all compositing runs through the plain C
+reference loops, for comparing their results and speed.
+
+\param enable 1 to use SSE2 or NEON where available, 0 for the reference kernels.
+*/
+void compositeUseVectorKernels(int enable)
+{
+	_useVectorKernels = enable;
+}
+
+/*!
+\brief Premultiplies the colors of a surface by its alpha channel, in place.
+
+This prepares a surface for the premultiplied blits, e.g. text rendered by
+SDL_ttf. It runs once per surface and has no vector version.
+
+\param surface The 32 bit surface with an alpha channel to convert.
+
+\return 0 on success, -1 for surfaces with incorrect format.
+*/
+int premultiplySurfaceAlpha(SDL_Surface * surface)
+{
+	int x, y, ashift;
+	Uint32 amask;
+
+	if (surface == NULL || !_isCompositeTarget(surface) || surface->format->Amask == 0)
+		return -1;
+	ashift = surface->format->Ashift;
+	amask = surface->format->Amask;
+
+	if (SDL_MUSTLOCK(surface)) {
+		SDL_LockSurface(surface);
+	}
+
+	for (y = 0; y < surface->h; y++) {
+		Uint32 *row = (Uint32 *) ((Uint8 *) surface->pixels + y * surface->pitch);
+		for (x = 0; x < surface->w; x++) {
+			Uint32 a = (row[x] >> ashift) & 0xff;
+			row[x] = (_scalePixel(row[x], a) & ~amask) | (row[x] & amask);
+		}
+	}
+
+	if (SDL_MUSTLOCK(surface)) {
+		SDL_UnlockSurface(surface);
+	}
+
+	return 0;
+}
+
+/*!
+\brief Blends a rectangle of a surface with a constant color.
+
+The color is drawn with the given opacity over the pixels within both the
+rectangle and the clip rectangle of the surface, which is how a translucent
+overlay band is drawn.
+
+\param dst The 32 bit surface to draw on.
+\param rect The rectangle to fill, NULL for the whole surface.
+\param color The color in the pixel format of the surface, e.g. from SDL_MapRGB.
+\param alpha The opacity of the color.
+
+\return 0 on success, -1 for surfaces with incorrect format.
+*/
+int fillBlendSurface(SDL_Surface * dst, const SDL_Rect * rect, Uint32 color, Uint8 alpha)
+{
+	SDL_Rect area;
+	Uint32 scaled;
+	int y;
+
+	if (dst == NULL || !_isCompositeTarget(dst))
+		return -1;
+	if (rect == NULL) {
+		area = dst->clip_rect;
+	} else if (!SDL_IntersectRect(rect, &dst->clip_rect, &area)) {
+		return 0;
+	}
+
+	if (SDL_MUSTLOCK(dst)) {
+		SDL_LockSurface(dst);
+	}
+
+	scaled = _scalePixel(color, alpha);
+	for (y = area.y; y < area.y + area.h; y++) {
+		Uint32 *row = (Uint32 *) ((Uint8 *) dst->pixels + y * dst->pitch) + area.x;
+		_fillBlendRow(row, area.w, scaled, 255u - alpha);
+	}
+
+	if (SDL_MUSTLOCK(dst)) {
+		SDL_UnlockSurface(dst);
+	}
+
+	return 0;
+}
+
+/*!
+\brief Blends a premultiplied surface, rotated in steps of 90 degrees, onto another surface.
+
+The pixels of a rotated row lie in a column of the source, they are gathered
+into a small buffer and then blended as a row. A source that is not rotated
+is blended directly.
+
+\param src The premultiplied 32 bit source surface with an alpha channel.
+\param dst The destination surface, with the same color layout.
+\param x The left edge of the rotated source on the destination.
+\param y The top edge of the rotated source on the destination.
+\param numClockwiseTurns Number of clockwise 90 degree turns to apply to the source.
+\param alpha The opacity of the source.
+
+\return 0 on success, -1 for surfaces with incorrect format.
+*/
+int blitPremultipliedSurface90Degrees(SDL_Surface * src, SDL_Surface * dst, int x, int y,
+	int numClockwiseTurns, Uint8 alpha)
+{
+	SDL_Rect bounds, area;
+	Uint32 buffer[COMPOSITE_GATHER];
+	int row, col, count, ashift;
+	ptrdiff_t step;
+
+	if (src == NULL || dst == NULL || !_isCompositeTarget(src) || !_isCompositeTarget(dst))
+		return -1;
+	if (src->format->Amask == 0 ||
+		src->format->Rmask != dst->format->Rmask ||
+		src->format->Gmask != dst->format->Gmask ||
+		src->format->Bmask != dst->format->Bmask)
+		return -1;
+	if (alpha == 0)
+		return 0;
+
+	/* normalize numClockwiseTurns */
+	while (numClockwiseTurns < 0) { numClockwiseTurns += 4; }
+	numClockwiseTurns = (numClockwiseTurns % 4);
+
+	bounds.x = x;
+	bounds.y = y;
+	bounds.w = (numClockwiseTurns % 2) ? src->h : src->w;
+	bounds.h = (numClockwiseTurns % 2) ? src->w : src->h;
+	if (!SDL_IntersectRect(&bounds, &dst->clip_rect, &area))
+		return 0;
+
+	/* byte step in the source between neighbouring destination pixels of a row */
+	switch (numClockwiseTurns) {
+	case 0: step = 4; break;
+	case 1: step = -src->pitch; break;
+	case 2: step = -4; break;
+	default: step = src->pitch; break;
+	}
+
+	if (SDL_MUSTLOCK(src)) {
+		SDL_LockSurface(src);
+	}
+	if (SDL_MUSTLOCK(dst)) {
+		SDL_LockSurface(dst);
+	}
+
+	ashift = src->format->Ashift;
+	for (row = area.y; row < area.y + area.h; row++) {
+		Uint32 *dstRow = (Uint32 *) ((Uint8 *) dst->pixels + row * dst->pitch);
+		int u = area.x - x, v = row - y;
+		int sx, sy;
+		const Uint8 *from;
+
+		/* source pixel of the first destination pixel of the row */
+		switch (numClockwiseTurns) {
+		case 0: sx = u; sy = v; break;
+		case 1: sx = v; sy = src->h - 1 - u; break;
+		case 2: sx = src->w - 1 - u; sy = src->h - 1 - v; break;
+		default: sx = src->w - 1 - v; sy = u; break;
+		}
+		from = (const Uint8 *) src->pixels + sy * src->pitch + sx * 4;
+
+		if (numClockwiseTurns == 0) {
+			_blendRowPremultiplied((const Uint32 *) from, dstRow + area.x, area.w, alpha, ashift);
+			continue;
+		}
+
+		for (col = area.x; col < area.x + area.w; col += count) {
+			int i;
+			count = area.x + area.w - col;
+			if (count > COMPOSITE_GATHER) {
+				count = COMPOSITE_GATHER;
+			}
+			for (i = 0; i < count; i++) {
+				memcpy(&buffer[i], from, 4);
+				from += step;
+			}
+			_blendRowPremultiplied(buffer, dstRow + col, count, alpha, ashift);
+		}
+	}
+
+	if (SDL_MUSTLOCK(dst)) {
+		SDL_UnlockSurface(dst);
+	}
+	if (SDL_MUSTLOCK(src)) {
+		SDL_UnlockSurface(src);
+	}
+
+	return 0;
+}
+
+/*!
+\brief Blends a premultiplied surface onto another surface.
+
+Meant for text, which SDL_ttf renders with a straight alpha channel, so the
+text surface is premultiplied once with premultiplySurfaceAlpha and can then
+be blended at any opacity without dividing by alpha.
+
+\param src The premultiplied 32 bit source surface with an alpha channel.
+\param dst The destination surface, with the same color layout.
+\param x The left edge of the source on the destination.
+\param y The top edge of the source on the destination.
+\param alpha The opacity of the source.
+
+\return 0 on success, -1 for surfaces with incorrect format.
+*/
+int blitPremultipliedSurface(SDL_Surface * src, SDL_Surface * dst, int x, int y, Uint8 alpha)
+{
+	return blitPremultipliedSurface90Degrees(src, dst, x, y, 0, alpha);
+}
@@ -0,0 +1,51 @@
+/*
+
+SDL_composite.h: alpha compositing kernels for SDL surfaces
+
+*/
+
+#ifndef _SDL_composite_h
+#define _SDL_composite_h
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <SDL.h>
+
+	/* ---- Function Prototypes */
+
+	/*
+
+	Kernel selection
+
+	*/
+
+	extern void compositeUseVectorKernels(int enable);
+
+	/*
+
+	Preparation functions
+
+	*/
+
+	extern int premultiplySurfaceAlpha(SDL_Surface * surface);
+
+	/*
+
+	Compositing functions
+
+	*/
+
+	extern int fillBlendSurface(SDL_Surface * dst, const SDL_Rect * rect, Uint32 color, Uint8 alpha);
+	extern int blitPremultipliedSurface(SDL_Surface * src, SDL_Surface * dst, int x, int y, Uint8 alpha);
+	extern int blitPremultipliedSurface90Degrees(SDL_Surface * src, SDL_Surface * dst, int x, int y,
+		int numClockwiseTurns, Uint8 alpha);
+
+	/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _SDL_composite_h */
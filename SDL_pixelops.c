@@ -0,0 +1,240 @@
+/*
+
+SDL_pixelops.c: pixel analysis and conversion kernels for SDL surfaces
+
+The kernels use SSE2 or NEON when the compiler enables them and fall back
+to plain C otherwise.
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "SDL_pixelops.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define PIXELOPS_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PIXELOPS_NEON 1
+#endif
+
+/*!
+\brief 4x4 Bayer matrix used for ordered dithering, values 0 to 15.
+*/
+static const Uint8 _bayer4[4][4] = {
+	{ 0,  8,  2, 10},
+	{12,  4, 14,  6},
+	{ 3, 11,  1,  9},
+	{15,  7, 13,  5}
+};
+
+/*!
+\brief Internal AND-reduction of a row of 32 bit pixels.
+
+\param row Pointer to the first pixel of the row.
+\param width Number of pixels in the row.
+
+\return The bitwise AND of all pixels in the row.
+*/
+static Uint32 _andRow32(const Uint32 *row, int width)
+{
+	Uint32 acc = 0xffffffff;
+	int x = 0;
+
+#if defined(PIXELOPS_SSE2)
+	__m128i vacc = _mm_set1_epi32(-1);
+	for (; x + 16 <= width; x += 16) {
+		__m128i a = _mm_and_si128(_mm_loadu_si128((const __m128i *) (row + x)),
+			_mm_loadu_si128((const __m128i *) (row + x + 4)));
+		__m128i b = _mm_and_si128(_mm_loadu_si128((const __m128i *) (row + x + 8)),
+			_mm_loadu_si128((const __m128i *) (row + x + 12)));
+		vacc = _mm_and_si128(vacc, _mm_and_si128(a, b));
+	}
+	vacc = _mm_and_si128(vacc, _mm_shuffle_epi32(vacc, _MM_SHUFFLE(1, 0, 3, 2)));
+	vacc = _mm_and_si128(vacc, _mm_shuffle_epi32(vacc, _MM_SHUFFLE(2, 3, 0, 1)));
+	acc = (Uint32) _mm_cvtsi128_si32(vacc);
+#elif defined(PIXELOPS_NEON)
+	uint32x4_t vacc = vdupq_n_u32(0xffffffff);
+	for (; x + 16 <= width; x += 16) {
+		uint32x4_t a = vandq_u32(vld1q_u32(row + x), vld1q_u32(row + x + 4));
+		uint32x4_t b = vandq_u32(vld1q_u32(row + x + 8), vld1q_u32(row + x + 12));
+		vacc = vandq_u32(vacc, vandq_u32(a, b));
+	}
+	acc = vgetq_lane_u32(vacc, 0) & vgetq_lane_u32(vacc, 1) &
+		vgetq_lane_u32(vacc, 2) & vgetq_lane_u32(vacc, 3);
+#endif
+
+	for (; x < width; x++) {
+		acc &= row[x];
+	}
+	return acc;
+}
+
+/*!
+\brief Tests whether every pixel of a surface is fully opaque.
+
+Surfaces without an alpha channel are always opaque. For 32 bit surfaces
+with an alpha channel the alpha bits of all pixels are AND-reduced row by
+row, and the scan stops at the first row containing a translucent pixel.
+Other formats with an alpha channel are reported as not opaque.
+
+\param src The surface to analyse.
+
+\return 1 if the surface is opaque, 0 otherwise.
+*/
+int surfaceIsOpaque(SDL_Surface * src)
+{
+	int y, opaque;
+	Uint32 amask;
+
+	if (src == NULL)
+		return 0;
+
+	amask = src->format->Amask;
+	if (amask == 0)
+		return 1;
+	if (src->format->BitsPerPixel != 32)
+		return 0;
+
+	if (SDL_MUSTLOCK(src)) {
+		SDL_LockSurface(src);
+	}
+
+	opaque = 1;
+	for (y = 0; y < src->h && opaque; y++) {
+		const Uint32 *row = (const Uint32 *) ((const Uint8 *) src->pixels + y * src->pitch);
+		opaque = ((_andRow32(row, src->w) & amask) == amask);
+	}
+
+	if (SDL_MUSTLOCK(src)) {
+		SDL_UnlockSurface(src);
+	}
+
+	return opaque;
+}
+
+/*!
+\brief Internal conversion of one row of 32 bit pixels to dithered RGB565.
+
+The dither offsets are pre-shifted into the source pixel layout, so they can
+be added to whole pixels with byte-wise saturation before each channel is
+truncated to 5 or 6 bits.
+
+\param src Pointer to the first source pixel of the row.
+\param dst Pointer to the first destination pixel of the row.
+\param width Number of pixels in the row.
+\param dither The dither offsets of the four columns of the row, in source layout.
+\param rshift The bit position of red in the source pixels.
+\param gshift The bit position of green in the source pixels.
+\param bshift The bit position of blue in the source pixels.
+*/
+static void _ditherRowRGB565(const Uint32 *src, Uint16 *dst, int width, const Uint32 dither[4],
+	int rshift, int gshift, int bshift)
+{
+	int x = 0;
+
+#if defined(PIXELOPS_SSE2)
+	__m128i vdither = _mm_loadu_si128((const __m128i *) dither);
+	__m128i mask5 = _mm_set1_epi32(0x1f);
+	__m128i mask6 = _mm_set1_epi32(0x3f);
+	__m128i bias = _mm_set1_epi32(0x8000);
+	__m128i rs = _mm_cvtsi32_si128(rshift + 3);
+	__m128i gs = _mm_cvtsi32_si128(gshift + 2);
+	__m128i bs = _mm_cvtsi32_si128(bshift + 3);
+	for (; x + 8 <= width; x += 8) {
+		__m128i p0 = _mm_adds_epu8(_mm_loadu_si128((const __m128i *) (src + x)), vdither);
+		__m128i p1 = _mm_adds_epu8(_mm_loadu_si128((const __m128i *) (src + x + 4)), vdither);
+		__m128i c0 = _mm_or_si128(_mm_or_si128(
+			_mm_slli_epi32(_mm_and_si128(_mm_srl_epi32(p0, rs), mask5), 11),
+			_mm_slli_epi32(_mm_and_si128(_mm_srl_epi32(p0, gs), mask6), 5)),
+			_mm_and_si128(_mm_srl_epi32(p0, bs), mask5));
+		__m128i c1 = _mm_or_si128(_mm_or_si128(
+			_mm_slli_epi32(_mm_and_si128(_mm_srl_epi32(p1, rs), mask5), 11),
+			_mm_slli_epi32(_mm_and_si128(_mm_srl_epi32(p1, gs), mask6), 5)),
+			_mm_and_si128(_mm_srl_epi32(p1, bs), mask5));
+		/* bias into the signed range so that the saturating pack is exact */
+		__m128i packed = _mm_packs_epi32(_mm_sub_epi32(c0, bias), _mm_sub_epi32(c1, bias));
+		_mm_storeu_si128((__m128i *) (dst + x), _mm_xor_si128(packed, _mm_set1_epi16((short) 0x8000)));
+	}
+#elif defined(PIXELOPS_NEON)
+	uint8x16_t vdither = vreinterpretq_u8_u32(vld1q_u32(dither));
+	int32x4_t rs = vdupq_n_s32(-(rshift + 3));
+	int32x4_t gs = vdupq_n_s32(-(gshift + 2));
+	int32x4_t bs = vdupq_n_s32(-(bshift + 3));
+	uint32x4_t mask5 = vdupq_n_u32(0x1f);
+	uint32x4_t mask6 = vdupq_n_u32(0x3f);
+	for (; x + 4 <= width; x += 4) {
+		uint32x4_t p = vreinterpretq_u32_u8(vqaddq_u8(vreinterpretq_u8_u32(vld1q_u32(src + x)), vdither));
+		uint32x4_t c = vorrq_u32(vorrq_u32(
+			vshlq_n_u32(vandq_u32(vshlq_u32(p, rs), mask5), 11),
+			vshlq_n_u32(vandq_u32(vshlq_u32(p, gs), mask6), 5)),
+			vandq_u32(vshlq_u32(p, bs), mask5));
+		vst1_u16(dst + x, vmovn_u32(c));
+	}
+#endif
+
+	for (; x < width; x++) {
+		Uint32 p = src[x];
+		Uint32 d = dither[x & 3];
+		Uint32 r = ((p >> rshift) & 0xff) + ((d >> rshift) & 0xff);
+		Uint32 g = ((p >> gshift) & 0xff) + ((d >> gshift) & 0xff);
+		Uint32 b = ((p >> bshift) & 0xff) + ((d >> bshift) & 0xff);
+		if (r > 0xff) r = 0xff;
+		if (g > 0xff) g = 0xff;
+		if (b > 0xff) b = 0xff;
+		dst[x] = (Uint16) (((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+	}
+}
+
+/*!
+\brief Converts a 32 bit surface to RGB565 with ordered dithering.
+
+Each channel is offset by a 4x4 Bayer threshold scaled to its quantization
+step before it is truncated, which hides the banding of 16 bit color. The
+alpha channel is discarded, so this is meant for opaque surfaces.
+
+\param src The 32 bit surface to convert, with 8 bits per color channel.
+
+\return The new RGB565 surface; or NULL for surfaces with incorrect input format.
+*/
+SDL_Surface *ditherSurfaceRGB565(SDL_Surface * src)
+{
+	SDL_Surface *dst;
+	const SDL_PixelFormat *format;
+	Uint32 dither[4];
+	int x, y;
+
+	if (src == NULL || src->format->BitsPerPixel != 32)
+		return NULL;
+	format = src->format;
+	if (format->Rloss != 0 || format->Gloss != 0 || format->Bloss != 0)
+		return NULL;
+
+	dst = SDL_CreateRGBSurface(SDL_SWSURFACE, src->w, src->h, 16, 0xf800, 0x07e0, 0x001f, 0);
+	if (dst == NULL)
+		return NULL;
+
+	if (SDL_MUSTLOCK(src)) {
+		SDL_LockSurface(src);
+	}
+
+	for (y = 0; y < src->h; y++) {
+		/* thresholds scaled to the 5 bit (step 8) and 6 bit (step 4) channels */
+		for (x = 0; x < 4; x++) {
+			Uint32 t = _bayer4[y & 3][x];
+			dither[x] = ((t >> 1) << format->Rshift) | ((t >> 2) << format->Gshift) | ((t >> 1) << format->Bshift);
+		}
+		_ditherRowRGB565(
+			(const Uint32 *) ((const Uint8 *) src->pixels + y * src->pitch),
+			(Uint16 *) ((Uint8 *) dst->pixels + y * dst->pitch),
+			src->w, dither, format->Rshift, format->Gshift, format->Bshift);
+	}
+
+	if (SDL_MUSTLOCK(src)) {
+		SDL_UnlockSurface(src);
+	}
+
+	return dst;
+}
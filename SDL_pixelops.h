@@ -0,0 +1,40 @@
+/*
+
+SDL_pixelops.h: pixel analysis and conversion kernels for SDL surfaces
+
+*/
+
+#ifndef _SDL_pixelops_h
+#define _SDL_pixelops_h
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <SDL.h>
+
+	/* ---- Function Prototypes */
+
+	/*
+
+	Analysis functions
+
+	*/
+
+	extern int surfaceIsOpaque(SDL_Surface * src);
+
+	/*
+
+	Conversion functions
+
+	*/
+
+	extern SDL_Surface *ditherSurfaceRGB565(SDL_Surface * src);
+
+	/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _SDL_pixelops_h */
@@ -38,6 +38,14 @@ Andreas Schiffler -- aschiffler at ferzkopp dot net
 
 #include "SDL_rotozoom.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ROTOZOOM_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ROTOZOOM_NEON 1
+#endif
+
 /* ---- Internally used structures */
 
 /*!
@@ -62,6 +70,11 @@ typedef struct tColorY {
 */
 #define MAX(a,b)    (((a) > (b)) ? (a) : (b))
 
+/*!
+\brief Returns minimum of two numbers a and b.
+*/
+#define MIN(a,b)    (((a) < (b)) ? (a) : (b))
+
 /*!
 \brief Number of guard rows added to destination surfaces.
 
@@ -801,11 +814,192 @@ void transformSurfaceY(SDL_Surface * src, SDL_Surface * dst, int cx, int cy, int
 }
 
 /*!
-\brief Rotates a 32 bit surface in increments of 90 degrees.
+\brief Edge length in pixels of the square tiles used by the 90 degree rotator.
+
+A tile of 32 bit pixels spans 64 bytes per row, so the source and destination
+rows touched by one tile stay resident in L1 cache while it is transposed.
+Must be a multiple of 8.
+*/
+#define TRANSPOSE_TILE 16
+
+/*!
+\brief Transposes a 4x4 block of 32 bit pixels.
+
+Pixel (row i, column j) of the block at 'src' is written to (row j, column i)
+of the block at 'dst'. Pitches are in bytes and may be negative.
+*/
+static void _transposeBlock32(const Uint8 *src, int spitch, Uint8 *dst, int dpitch)
+{
+#if defined(ROTOZOOM_SSE2)
+	__m128i r0 = _mm_loadu_si128((const __m128i *) (src));
+	__m128i r1 = _mm_loadu_si128((const __m128i *) (src + spitch));
+	__m128i r2 = _mm_loadu_si128((const __m128i *) (src + 2 * spitch));
+	__m128i r3 = _mm_loadu_si128((const __m128i *) (src + 3 * spitch));
+	__m128i t0 = _mm_unpacklo_epi32(r0, r1);
+	__m128i t1 = _mm_unpacklo_epi32(r2, r3);
+	__m128i t2 = _mm_unpackhi_epi32(r0, r1);
+	__m128i t3 = _mm_unpackhi_epi32(r2, r3);
+	_mm_storeu_si128((__m128i *) (dst), _mm_unpacklo_epi64(t0, t1));
+	_mm_storeu_si128((__m128i *) (dst + dpitch), _mm_unpackhi_epi64(t0, t1));
+	_mm_storeu_si128((__m128i *) (dst + 2 * dpitch), _mm_unpacklo_epi64(t2, t3));
+	_mm_storeu_si128((__m128i *) (dst + 3 * dpitch), _mm_unpackhi_epi64(t2, t3));
+#elif defined(ROTOZOOM_NEON)
+	uint32x4x2_t t01 = vtrnq_u32(vld1q_u32((const uint32_t *) (src)),
+		vld1q_u32((const uint32_t *) (src + spitch)));
+	uint32x4x2_t t23 = vtrnq_u32(vld1q_u32((const uint32_t *) (src + 2 * spitch)),
+		vld1q_u32((const uint32_t *) (src + 3 * spitch)));
+	vst1q_u32((uint32_t *) (dst), vcombine_u32(vget_low_u32(t01.val[0]), vget_low_u32(t23.val[0])));
+	vst1q_u32((uint32_t *) (dst + dpitch), vcombine_u32(vget_low_u32(t01.val[1]), vget_low_u32(t23.val[1])));
+	vst1q_u32((uint32_t *) (dst + 2 * dpitch), vcombine_u32(vget_high_u32(t01.val[0]), vget_high_u32(t23.val[0])));
+	vst1q_u32((uint32_t *) (dst + 3 * dpitch), vcombine_u32(vget_high_u32(t01.val[1]), vget_high_u32(t23.val[1])));
+#else
+	int i, j;
+	for (i = 0; i < 4; i++) {
+		for (j = 0; j < 4; j++) {
+			*(Uint32 *) (dst + j * dpitch + i * 4) = *(const Uint32 *) (src + i * spitch + j * 4);
+		}
+	}
+#endif
+}
+
+/*!
+\brief Transposes an 8x8 block of 16 bit pixels.
+
+Pixel (row i, column j) of the block at 'src' is written to (row j, column i)
+of the block at 'dst'. Pitches are in bytes and may be negative.
+*/
+static void _transposeBlock16(const Uint8 *src, int spitch, Uint8 *dst, int dpitch)
+{
+#if defined(ROTOZOOM_SSE2)
+	__m128i r0 = _mm_loadu_si128((const __m128i *) (src));
+	__m128i r1 = _mm_loadu_si128((const __m128i *) (src + spitch));
+	__m128i r2 = _mm_loadu_si128((const __m128i *) (src + 2 * spitch));
+	__m128i r3 = _mm_loadu_si128((const __m128i *) (src + 3 * spitch));
+	__m128i r4 = _mm_loadu_si128((const __m128i *) (src + 4 * spitch));
+	__m128i r5 = _mm_loadu_si128((const __m128i *) (src + 5 * spitch));
+	__m128i r6 = _mm_loadu_si128((const __m128i *) (src + 6 * spitch));
+	__m128i r7 = _mm_loadu_si128((const __m128i *) (src + 7 * spitch));
+	/* interleave pixel pairs, then pixel quads, then the 64 bit halves */
+	__m128i a = _mm_unpacklo_epi16(r0, r1);
+	__m128i b = _mm_unpacklo_epi16(r2, r3);
+	__m128i c = _mm_unpacklo_epi16(r4, r5);
+	__m128i d = _mm_unpacklo_epi16(r6, r7);
+	__m128i e = _mm_unpackhi_epi16(r0, r1);
+	__m128i f = _mm_unpackhi_epi16(r2, r3);
+	__m128i g = _mm_unpackhi_epi16(r4, r5);
+	__m128i h = _mm_unpackhi_epi16(r6, r7);
+	__m128i ab0 = _mm_unpacklo_epi32(a, b);
+	__m128i ab1 = _mm_unpackhi_epi32(a, b);
+	__m128i cd0 = _mm_unpacklo_epi32(c, d);
+	__m128i cd1 = _mm_unpackhi_epi32(c, d);
+	__m128i ef0 = _mm_unpacklo_epi32(e, f);
+	__m128i ef1 = _mm_unpackhi_epi32(e, f);
+	__m128i gh0 = _mm_unpacklo_epi32(g, h);
+	__m128i gh1 = _mm_unpackhi_epi32(g, h);
+	_mm_storeu_si128((__m128i *) (dst), _mm_unpacklo_epi64(ab0, cd0));
+	_mm_storeu_si128((__m128i *) (dst + dpitch), _mm_unpackhi_epi64(ab0, cd0));
+	_mm_storeu_si128((__m128i *) (dst + 2 * dpitch), _mm_unpacklo_epi64(ab1, cd1));
+	_mm_storeu_si128((__m128i *) (dst + 3 * dpitch), _mm_unpackhi_epi64(ab1, cd1));
+	_mm_storeu_si128((__m128i *) (dst + 4 * dpitch), _mm_unpacklo_epi64(ef0, gh0));
+	_mm_storeu_si128((__m128i *) (dst + 5 * dpitch), _mm_unpackhi_epi64(ef0, gh0));
+	_mm_storeu_si128((__m128i *) (dst + 6 * dpitch), _mm_unpacklo_epi64(ef1, gh1));
+	_mm_storeu_si128((__m128i *) (dst + 7 * dpitch), _mm_unpackhi_epi64(ef1, gh1));
+#elif defined(ROTOZOOM_NEON)
+	/* swap pixel pairs, then pixel quads, then recombine the 64 bit halves */
+	uint16x8x2_t t0 = vtrnq_u16(vld1q_u16((const uint16_t *) (src)),
+		vld1q_u16((const uint16_t *) (src + spitch)));
+	uint16x8x2_t t1 = vtrnq_u16(vld1q_u16((const uint16_t *) (src + 2 * spitch)),
+		vld1q_u16((const uint16_t *) (src + 3 * spitch)));
+	uint16x8x2_t t2 = vtrnq_u16(vld1q_u16((const uint16_t *) (src + 4 * spitch)),
+		vld1q_u16((const uint16_t *) (src + 5 * spitch)));
+	uint16x8x2_t t3 = vtrnq_u16(vld1q_u16((const uint16_t *) (src + 6 * spitch)),
+		vld1q_u16((const uint16_t *) (src + 7 * spitch)));
+	uint32x4x2_t u0 = vtrnq_u32(vreinterpretq_u32_u16(t0.val[0]), vreinterpretq_u32_u16(t1.val[0]));
+	uint32x4x2_t u1 = vtrnq_u32(vreinterpretq_u32_u16(t0.val[1]), vreinterpretq_u32_u16(t1.val[1]));
+	uint32x4x2_t u2 = vtrnq_u32(vreinterpretq_u32_u16(t2.val[0]), vreinterpretq_u32_u16(t3.val[0]));
+	uint32x4x2_t u3 = vtrnq_u32(vreinterpretq_u32_u16(t2.val[1]), vreinterpretq_u32_u16(t3.val[1]));
+	vst1q_u32((uint32_t *) (dst), vcombine_u32(vget_low_u32(u0.val[0]), vget_low_u32(u2.val[0])));
+	vst1q_u32((uint32_t *) (dst + dpitch), vcombine_u32(vget_low_u32(u1.val[0]), vget_low_u32(u3.val[0])));
+	vst1q_u32((uint32_t *) (dst + 2 * dpitch), vcombine_u32(vget_low_u32(u0.val[1]), vget_low_u32(u2.val[1])));
+	vst1q_u32((uint32_t *) (dst + 3 * dpitch), vcombine_u32(vget_low_u32(u1.val[1]), vget_low_u32(u3.val[1])));
+	vst1q_u32((uint32_t *) (dst + 4 * dpitch), vcombine_u32(vget_high_u32(u0.val[0]), vget_high_u32(u2.val[0])));
+	vst1q_u32((uint32_t *) (dst + 5 * dpitch), vcombine_u32(vget_high_u32(u1.val[0]), vget_high_u32(u3.val[0])));
+	vst1q_u32((uint32_t *) (dst + 6 * dpitch), vcombine_u32(vget_high_u32(u0.val[1]), vget_high_u32(u2.val[1])));
+	vst1q_u32((uint32_t *) (dst + 7 * dpitch), vcombine_u32(vget_high_u32(u1.val[1]), vget_high_u32(u3.val[1])));
+#else
+	int i, j;
+	for (i = 0; i < 8; i++) {
+		for (j = 0; j < 8; j++) {
+			*(Uint16 *) (dst + j * dpitch + i * 2) = *(const Uint16 *) (src + i * spitch + j * 2);
+		}
+	}
+#endif
+}
+
+/*!
+\brief Internal cache-blocked transpose of a pixel buffer.
+
+Writes pixel (row i, column j) of the w x h 'src' buffer to (row j, column i)
+of 'dst'. Pitches are in bytes and may be negative to flip either buffer
+vertically, which turns the transpose into a 90 degree rotation.
+The buffers are walked in TRANSPOSE_TILE sized tiles; full 4x4 (32 bit) or
+8x8 (16 bit) blocks inside a tile are transposed in registers and the
+remaining edge pixels are copied one by one.
+
+\param src Pointer to the first pixel of the source buffer.
+\param spitch The source pitch in bytes.
+\param dst Pointer to the first pixel of the destination buffer.
+\param dpitch The destination pitch in bytes.
+\param w The source width in pixels.
+\param h The source height in pixels.
+\param bpp The number of bytes per pixel (1 to 4).
+*/
+static void _transposePixels(const Uint8 *src, int spitch, Uint8 *dst, int dpitch, int w, int h, int bpp)
+{
+	int tx, ty, x, y, xend, yend, k;
+	int block = (bpp == 4) ? 4 : ((bpp == 2) ? 8 : 0);
+
+	for (ty = 0; ty < h; ty += TRANSPOSE_TILE) {
+		yend = MIN(ty + TRANSPOSE_TILE, h);
+		for (tx = 0; tx < w; tx += TRANSPOSE_TILE) {
+			xend = MIN(tx + TRANSPOSE_TILE, w);
+			y = ty;
+			/* register transposes over the full blocks of the tile */
+			if (block) {
+				for (; y + block <= yend; y += block) {
+					for (x = tx; x + block <= xend; x += block) {
+						if (bpp == 4) {
+							_transposeBlock32(src + y * spitch + x * 4, spitch, dst + x * dpitch + y * 4, dpitch);
+						} else {
+							_transposeBlock16(src + y * spitch + x * 2, spitch, dst + x * dpitch + y * 2, dpitch);
+						}
+					}
+					/* right edge of the block row */
+					for (; x < xend; x++) {
+						for (k = y; k < y + block; k++) {
+							memcpy(dst + x * dpitch + k * bpp, src + k * spitch + x * bpp, bpp);
+						}
+					}
+				}
+			}
+			/* bottom edge of the tile, or the whole tile for 8 and 24 bit */
+			for (; y < yend; y++) {
+				for (x = tx; x < xend; x++) {
+					memcpy(dst + x * dpitch + y * bpp, src + y * spitch + x * bpp, bpp);
+				}
+			}
+		}
+	}
+}
+
+/*!
+\brief Rotates a surface in increments of 90 degrees.
 
 Specialized 90 degree rotator which rotates a 'src' surface in 90 degree
 increments clockwise returning a new surface. Faster than rotozoomer since
-not scanning or interpolation takes place. Input surface must be 32 bit.
+not scanning or interpolation takes place. Input surface must be 8, 16, 24
+or 32 bit. Quarter turns are done with a cache-blocked transpose which uses
+SSE2 or NEON register transposes for 16 and 32 bit surfaces when available.
 (code contributed by J. Schiller, improved by C. Allport and A. Schiffler)
 
 \param src Source surface to rotate.
@@ -816,13 +1010,14 @@ not scanning or interpolation takes place. Input surface must be 32 bit.
 SDL_Surface* rotateSurface90Degrees(SDL_Surface* src, int numClockwiseTurns)
 {
 	int row, col, newWidth, newHeight;
-	int bpp, src_ipr, dst_ipr;
+	int bpp;
 	SDL_Surface* dst;
-	Uint32* srcBuf;
-	Uint32* dstBuf;
+	Uint8* srcBuf;
+	Uint8* dstBuf;
 
-	/* Has to be a valid surface pointer and only 32-bit surfaces (for now) */
-	if (!src || src->format->BitsPerPixel != 32) { return NULL; }
+	/* Has to be a valid surface pointer with a whole number of bytes per pixel */
+	if (!src || (src->format->BitsPerPixel != 8 && src->format->BitsPerPixel != 16 &&
+		src->format->BitsPerPixel != 24 && src->format->BitsPerPixel != 32)) { return NULL; }
 
 	/* normalize numClockwiseTurns */
 	while(numClockwiseTurns < 0) { numClockwiseTurns += 4; }
@@ -840,17 +1035,22 @@ SDL_Surface* rotateSurface90Degrees(SDL_Surface* src, int numClockwiseTurns)
 		return NULL;
 	}
 
-	if (SDL_MUSTLOCK(dst)) {
-		SDL_LockSurface(dst);
+	/* Keep the palette of 8 bit surfaces */
+	if (src->format->BitsPerPixel == 8 && src->format->palette && dst->format->palette) {
+		SDL_SetPaletteColors(dst->format->palette, src->format->palette->colors, 0,
+			MIN(src->format->palette->ncolors, dst->format->palette->ncolors));
+	}
+
+	if (SDL_MUSTLOCK(src)) {
+		SDL_LockSurface(src);
 	}
 	if (SDL_MUSTLOCK(dst)) {
 		SDL_LockSurface(dst);
 	}
 
-	/* Calculate int-per-row */
 	bpp = src->format->BitsPerPixel / 8;
-	src_ipr = src->pitch / bpp;
-	dst_ipr = dst->pitch / bpp;
+	srcBuf = (Uint8*)(src->pixels);
+	dstBuf = (Uint8*)(dst->pixels);
 
 	switch(numClockwiseTurns) {
 	case 0: /* Make a copy of the surface */
@@ -865,12 +1065,10 @@ SDL_Surface* rotateSurface90Degrees(SDL_Surface* src, int numClockwiseTurns)
 			else
 			{
 				/* If the pitch differs, copy each row separately */
-				srcBuf = (Uint32*)(src->pixels);
-				dstBuf = (Uint32*)(dst->pixels);
 				for (row = 0; row < src->h; row++) {
 					memcpy(dstBuf, srcBuf, dst->w * bpp);
-					srcBuf += src_ipr;
-					dstBuf += dst_ipr;
+					srcBuf += src->pitch;
+					dstBuf += dst->pitch;
 				} /* end for(col) */
 			} /* end for(row) */
 		}
@@ -879,45 +1077,39 @@ SDL_Surface* rotateSurface90Degrees(SDL_Surface* src, int numClockwiseTurns)
 		/* rotate clockwise */
 	case 1: /* rotated 90 degrees clockwise */
 		{
-			for (row = 0; row < src->h; ++row) {
-				srcBuf = (Uint32*)(src->pixels) + (row * src_ipr);
-				dstBuf = (Uint32*)(dst->pixels) + (dst->w - row - 1);
-				for (col = 0; col < src->w; ++col) {
-					*dstBuf = *srcBuf;
-					++srcBuf;
-					dstBuf += dst_ipr;
-				}
-				/* end for(col) */
-			}
-			/* end for(row) */
+			/* transpose the source read bottom-up: dst(col, row) = src(h - 1 - row, col) */
+			_transposePixels(srcBuf + (src->h - 1) * src->pitch, -src->pitch,
+				dstBuf, dst->pitch, src->w, src->h, bpp);
 		}
 		break;
 
 	case 2: /* rotated 180 degrees clockwise */
 		{
 			for (row = 0; row < src->h; ++row) {
-				srcBuf = (Uint32*)(src->pixels) + (row * src_ipr);
-				dstBuf = (Uint32*)(dst->pixels) + ((dst->h - row - 1) * dst_ipr) + (dst->w - 1);
-				for (col = 0; col < src->w; ++col) {
-					*dstBuf = *srcBuf;
-					++srcBuf;
-					--dstBuf;
+				Uint8* srcRow = srcBuf + (row * src->pitch);
+				Uint8* dstRow = dstBuf + ((dst->h - row - 1) * dst->pitch) + ((dst->w - 1) * bpp);
+				if (bpp == 4) {
+					for (col = 0; col < src->w; ++col) {
+						((Uint32*)dstRow)[-col] = ((Uint32*)srcRow)[col];
+					}
+				} else if (bpp == 2) {
+					for (col = 0; col < src->w; ++col) {
+						((Uint16*)dstRow)[-col] = ((Uint16*)srcRow)[col];
+					}
+				} else {
+					for (col = 0; col < src->w; ++col) {
+						memcpy(dstRow - col * bpp, srcRow + col * bpp, bpp);
+					}
 				}
 			}
 		}
 		break;
 
-	case 3:
+	case 3: /* rotated 270 degrees clockwise */
 		{
-			for (row = 0; row < src->h; ++row) {
-				srcBuf = (Uint32*)(src->pixels) + (row * src_ipr);
-				dstBuf = (Uint32*)(dst->pixels) + row + ((dst->h - 1) * dst_ipr);
-				for (col = 0; col < src->w; ++col) {
-					*dstBuf = *srcBuf;
-					++srcBuf;
-					dstBuf -= dst_ipr;
-				}
-			}
+			/* transpose into the destination written bottom-up: dst(w - 1 - col, row) = src(row, col) */
+			_transposePixels(srcBuf, src->pitch,
+				dstBuf + (dst->h - 1) * dst->pitch, -dst->pitch, src->w, src->h, bpp);
 		}
 		break;
 	}
@@ -0,0 +1,84 @@
+#include "alloc_counter.h"
+
+#ifdef ALLOC_COUNTER
+
+#include <cstdlib>
+#include <new>
+
+#include <SDL.h>
+
+namespace
+{
+    thread_local size_t allocations = 0;
+    thread_local size_t textures = 0;
+}
+
+// replace global operator new, the nothrow and array versions call it
+void *operator new(std::size_t size)
+{
+    allocations++;
+    void *ptr = std::malloc(size != 0 ? size : 1);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+// texture creation is hooked by the linker options
+// --wrap=SDL_CreateTexture and --wrap=SDL_CreateTextureFromSurface
+extern "C"
+{
+    SDL_Texture *__real_SDL_CreateTexture(SDL_Renderer *renderer, Uint32 format, int access, int w, int h);
+    SDL_Texture *__real_SDL_CreateTextureFromSurface(SDL_Renderer *renderer, SDL_Surface *surface);
+    SDL_Texture *__wrap_SDL_CreateTexture(SDL_Renderer *renderer, Uint32 format, int access, int w, int h);
+    SDL_Texture *__wrap_SDL_CreateTextureFromSurface(SDL_Renderer *renderer, SDL_Surface *surface);
+
+    SDL_Texture *__wrap_SDL_CreateTexture(SDL_Renderer *renderer, Uint32 format, int access, int w, int h)
+    {
+        textures++;
+        return __real_SDL_CreateTexture(renderer, format, access, w, h);
+    }
+
+    SDL_Texture *__wrap_SDL_CreateTextureFromSurface(SDL_Renderer *renderer, SDL_Surface *surface)
+    {
+        textures++;
+        return __real_SDL_CreateTextureFromSurface(renderer, surface);
+    }
+}
+
+namespace alloc_counter
+{
+    extern const bool isEnabled = true;
+
+    Counts get()
+    {
+        Counts counts;
+        counts.allocations = allocations;
+        counts.textures = textures;
+        return counts;
+    }
+
+} // namespace alloc_counter
+
+#else
+
+namespace alloc_counter
+{
+    extern const bool isEnabled = false;
+
+    Counts get()
+    {
+        return Counts();
+    }
+
+} // namespace alloc_counter
+
+#endif // ALLOC_COUNTER
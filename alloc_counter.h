@@ -0,0 +1,25 @@
+#ifndef ALLOC_COUNTER_H_
+#define ALLOC_COUNTER_H_
+
+#include <cstddef>
+
+// Debug counters of heap allocations made through operator new and of SDL
+// textures created, kept per thread. They are only compiled in when built
+// with "make ALLOC_COUNTER=1", otherwise isEnabled is false and all counts
+// stay zero.
+namespace alloc_counter
+{
+    struct Counts
+    {
+        size_t allocations = 0;
+        size_t textures = 0;
+    };
+
+    extern const bool isEnabled;
+
+    // counts of the calling thread since program start
+    Counts get();
+
+} // namespace alloc_counter
+
+#endif // ALLOC_COUNTER_H_
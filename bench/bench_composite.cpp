@@ -0,0 +1,248 @@
+// Micro-benchmark for the SDL_composite kernels.
+//
+// Blends synthetic surfaces the way frames are composited on the device, the
+// overlay band, a line of text and the same text rotated, and prints the
+// results as JSON on stdout. Every case runs the vector kernels and the C
+// reference kernels on identical input, the checksums of both outputs must
+// be the same.
+
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <functional>
+
+#include <SDL.h>
+
+#include "SDL_composite.h"
+
+using std::string;
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::vector;
+
+namespace
+{
+	// the screen of the device, in the orientation it is drawn in
+	const int SCREEN_W = 480;
+	const int SCREEN_H = 640;
+
+	// the title overlay band and a line of title text
+	const int BAND_W = 36;
+	const int TEXT_W = 600;
+	const int TEXT_H = 30;
+
+	struct Kernel
+	{
+		const char *name;
+		int pixels;   // destination pixels written per run
+		std::function<void(SDL_Surface *text, SDL_Surface *screen)> run;
+	};
+
+	int warmupRuns = 2;
+	int repeatRuns = 50;
+	string kernelFilter = "";
+
+	void printUsage()
+	{
+		cerr << "Usage: bench_composite [-w warmup] [-r repetitions] [-k kernel]" << endl
+			 << "-w:\tnumber of untimed warmup runs per case (default is 2)." << endl
+			 << "-r:\tnumber of timed runs per case (default is 50)." << endl
+			 << "-k:\tonly run the named kernel (fill, band, text, text90)." << endl;
+	}
+
+	void handleOptions(int argc, char *argv[])
+	{
+		int i = 1;
+		while (i < argc)
+		{
+			auto option = argv[i];
+			if (i == argc - 1)
+			{
+				printUsage();
+				exit(1);
+			}
+			if (strcmp(option, "-w") == 0)
+				warmupRuns = std::max(0, atoi(argv[i + 1]));
+			else if (strcmp(option, "-r") == 0)
+				repeatRuns = std::max(1, atoi(argv[i + 1]));
+			else if (strcmp(option, "-k") == 0)
+				kernelFilter = argv[i + 1];
+			else
+			{
+				printUsage();
+				exit(1);
+			}
+			i += 2;
+		}
+	}
+
+	// xorshift32, keeps the synthetic surfaces identical between builds
+	Uint32 nextRandom(Uint32 &state)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	// create an ARGB8888 surface of noise, text surfaces get an alpha
+	// channel like antialiased glyphs, mostly transparent or opaque
+	SDL_Surface *createSyntheticSurface(int w, int h, bool isText)
+	{
+		SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+		if (surface == nullptr)
+			return nullptr;
+
+		Uint32 state = 0x9e3779b9u ^ static_cast<Uint32>(w * 31 + h * 17);
+		for (int y = 0; y < h; y++)
+		{
+			auto row = reinterpret_cast<Uint32 *>(static_cast<Uint8 *>(surface->pixels) + y * surface->pitch);
+			for (int x = 0; x < w; x++)
+			{
+				Uint32 noise = nextRandom(state);
+				if (!isText)
+				{
+					row[x] = noise | 0xff000000u;
+					continue;
+				}
+				Uint32 coverage = noise >> 24;
+				Uint32 alpha = coverage < 160 ? 0 : coverage > 220 ? 255 : (coverage - 160) * 4;
+				row[x] = (alpha << 24) | (noise & 0x00ffffffu);
+			}
+		}
+		if (isText)
+			premultiplySurfaceAlpha(surface);
+		return surface;
+	}
+
+	// FNV-1a over the visible pixel bytes
+	Uint64 surfaceChecksum(const SDL_Surface *surface)
+	{
+		Uint64 hash = 1469598103934665603ull;
+		const int rowBytes = surface->w * surface->format->BytesPerPixel;
+		for (int y = 0; y < surface->h; y++)
+		{
+			auto row = static_cast<const Uint8 *>(surface->pixels) + y * surface->pitch;
+			for (int i = 0; i < rowBytes; i++)
+			{
+				hash ^= row[i];
+				hash *= 1099511628211ull;
+			}
+		}
+		return hash;
+	}
+
+	vector<Kernel> createKernels()
+	{
+		return {
+			{"fill", SCREEN_W * SCREEN_H, [](SDL_Surface *, SDL_Surface *screen) {
+				 fillBlendSurface(screen, nullptr, SDL_MapRGB(screen->format, 0, 0, 0), 160);
+			 }},
+			{"band", BAND_W * SCREEN_H, [](SDL_Surface *, SDL_Surface *screen) {
+				 SDL_Rect band = {0, 0, BAND_W, SCREEN_H};
+				 fillBlendSurface(screen, &band, SDL_MapRGB(screen->format, 0, 0, 0), 160);
+			 }},
+			{"text", TEXT_W * TEXT_H, [](SDL_Surface *text, SDL_Surface *screen) {
+				 blitPremultipliedSurface(text, screen, 0, 0, 200);
+			 }},
+			{"text90", TEXT_W * TEXT_H, [](SDL_Surface *text, SDL_Surface *screen) {
+				 blitPremultipliedSurface90Degrees(text, screen, 0, 0, 3, 200);
+			 }},
+		};
+	}
+
+	double elapsedNs(Uint64 start, Uint64 end)
+	{
+		return static_cast<double>(end - start) * 1e9 /
+			   static_cast<double>(SDL_GetPerformanceFrequency());
+	}
+
+	// time one kernel on a fresh screen, returns the median and the checksum of the first run
+	double timeKernel(const Kernel &kernel, SDL_Surface *text, SDL_Surface *background, Uint64 &checksum)
+	{
+		SDL_Surface *screen = SDL_ConvertSurfaceFormat(background, SDL_PIXELFORMAT_ARGB8888, 0);
+		for (int i = 0; i < warmupRuns; i++)
+			kernel.run(text, screen);
+
+		vector<double> times;
+		for (int i = 0; i < repeatRuns; i++)
+		{
+			if (i == 0)
+				SDL_BlitSurface(background, nullptr, screen, nullptr);
+			Uint64 start = SDL_GetPerformanceCounter();
+			kernel.run(text, screen);
+			Uint64 end = SDL_GetPerformanceCounter();
+			times.push_back(elapsedNs(start, end));
+			if (i == 0)
+				checksum = surfaceChecksum(screen);
+		}
+		SDL_FreeSurface(screen);
+
+		std::sort(times.begin(), times.end());
+		return times[times.size() / 2];
+	}
+
+	// run one kernel with both implementations and print the result as a JSON object
+	void runCase(const Kernel &kernel, SDL_Surface *text, SDL_Surface *background, bool first)
+	{
+		Uint64 vectorChecksum = 0, referenceChecksum = 0;
+		compositeUseVectorKernels(1);
+		double vectorNs = timeKernel(kernel, text, background, vectorChecksum);
+		compositeUseVectorKernels(0);
+		double referenceNs = timeKernel(kernel, text, background, referenceChecksum);
+		compositeUseVectorKernels(1);
+
+		char checksumText[32];
+		snprintf(checksumText, sizeof(checksumText), "%016llx", static_cast<unsigned long long>(vectorChecksum));
+
+		cout << (first ? "" : ",") << endl
+			 << "    {\"kernel\": \"" << kernel.name << "\", \"pixels\": " << kernel.pixels
+			 << ", \"reps\": " << repeatRuns
+			 << ", \"median_ns\": " << static_cast<long long>(vectorNs)
+			 << ", \"reference_median_ns\": " << static_cast<long long>(referenceNs)
+			 << ", \"ns_per_pixel\": " << vectorNs / kernel.pixels
+			 << ", \"speedup\": " << referenceNs / vectorNs
+			 << ", \"checksum\": \"" << checksumText << "\""
+			 << ", \"matches_reference\": " << (vectorChecksum == referenceChecksum ? "true" : "false") << "}";
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	handleOptions(argc, argv);
+
+	SDL_Surface *text = createSyntheticSurface(TEXT_W, TEXT_H, true);
+	SDL_Surface *background = createSyntheticSurface(SCREEN_W, SCREEN_H, false);
+	if (text == nullptr || background == nullptr)
+	{
+		cerr << "bench_composite: surface creation failed: " << SDL_GetError() << endl;
+		return 1;
+	}
+	SDL_SetSurfaceBlendMode(background, SDL_BLENDMODE_NONE);
+
+	cout << "{" << endl
+		 << "  \"warmup\": " << warmupRuns << "," << endl
+		 << "  \"repetitions\": " << repeatRuns << "," << endl
+		 << "  \"results\": [";
+
+	bool first = true;
+	for (const auto &kernel : createKernels())
+	{
+		if (!kernelFilter.empty() && kernelFilter != kernel.name)
+			continue;
+		runCase(kernel, text, background, first);
+		first = false;
+	}
+
+	cout << endl
+		 << "  ]" << endl
+		 << "}" << endl;
+
+	SDL_FreeSurface(text);
+	SDL_FreeSurface(background);
+	return 0;
+}
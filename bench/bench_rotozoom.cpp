@@ -0,0 +1,297 @@
+// Micro-benchmark for the SDL_rotozoom kernels.
+//
+// Generates synthetic 8, 24 and 32 bit surfaces at the sizes seen on the
+// device, runs each kernel with warmup and repetitions, and prints the
+// results as JSON on stdout. The checksum of every output surface is
+// included so that optimized kernels can be compared against older builds.
+
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <functional>
+
+#include <SDL.h>
+
+#include "SDL_rotozoom.h"
+
+using std::string;
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::vector;
+
+namespace
+{
+	struct SurfaceSize
+	{
+		const char *name;
+		int w, h;
+	};
+
+	// retro capture, screen size, box-art and 4K sources
+	const SurfaceSize sizes[] = {
+		{"320x240", 320, 240},
+		{"640x480", 640, 480},
+		{"1080p", 1920, 1080},
+		{"4k", 3840, 2160},
+	};
+
+	const int depths[] = {8, 24, 32};
+
+	// the viewport images are fitted into by ImageItem::loadImageToFit
+	const int FIT_W = 640;
+	const int FIT_H = 480;
+
+	struct Kernel
+	{
+		const char *name;
+		std::function<SDL_Surface *(SDL_Surface *)> run;
+	};
+
+	int warmupRuns = 2;
+	int repeatRuns = 10;
+	string kernelFilter = "";
+	string sizeFilter = "";
+
+	void printUsage()
+	{
+		cerr << "Usage: bench_rotozoom [-w warmup] [-r repetitions] [-k kernel] [-z size]" << endl
+			 << "-w:\tnumber of untimed warmup runs per case (default is 2)." << endl
+			 << "-r:\tnumber of timed runs per case (default is 10)." << endl
+			 << "-k:\tonly run the named kernel (zoom, shrink, rotate90, rotozoom)." << endl
+			 << "-z:\tonly run the named size (320x240, 640x480, 1080p, 4k)." << endl;
+	}
+
+	void handleOptions(int argc, char *argv[])
+	{
+		int i = 1;
+		while (i < argc)
+		{
+			auto option = argv[i];
+			if (i == argc - 1)
+			{
+				printUsage();
+				exit(1);
+			}
+			if (strcmp(option, "-w") == 0)
+				warmupRuns = std::max(0, atoi(argv[i + 1]));
+			else if (strcmp(option, "-r") == 0)
+				repeatRuns = std::max(1, atoi(argv[i + 1]));
+			else if (strcmp(option, "-k") == 0)
+				kernelFilter = argv[i + 1];
+			else if (strcmp(option, "-z") == 0)
+				sizeFilter = argv[i + 1];
+			else
+			{
+				printUsage();
+				exit(1);
+			}
+			i += 2;
+		}
+	}
+
+	// xorshift32, keeps the synthetic surfaces identical between builds
+	Uint32 nextRandom(Uint32 &state)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	// create a surface filled with a gradient plus noise, so that both
+	// smooth areas and sharp edges go through the filters
+	SDL_Surface *createSyntheticSurface(int w, int h, int depth)
+	{
+		SDL_Surface *surface = nullptr;
+		if (depth == 8)
+			surface = SDL_CreateRGBSurface(0, w, h, 8, 0, 0, 0, 0);
+		else if (depth == 24)
+			surface = SDL_CreateRGBSurface(0, w, h, 24, 0x0000ff, 0x00ff00, 0xff0000, 0);
+		else
+			surface = SDL_CreateRGBSurface(0, w, h, 32, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000);
+		if (surface == nullptr)
+			return nullptr;
+
+		if (depth == 8)
+		{
+			SDL_Color colors[256];
+			for (int i = 0; i < 256; i++)
+			{
+				auto v = static_cast<Uint8>(i);
+				colors[i] = {v, v, v, 255};
+			}
+			SDL_SetPaletteColors(surface->format->palette, colors, 0, 256);
+		}
+
+		Uint32 state = 0x9e3779b9u ^ static_cast<Uint32>(w * 31 + h * 17 + depth);
+		const int bpp = depth / 8;
+		for (int y = 0; y < h; y++)
+		{
+			auto row = static_cast<Uint8 *>(surface->pixels) + y * surface->pitch;
+			for (int x = 0; x < w; x++)
+			{
+				Uint32 noise = nextRandom(state);
+				for (int c = 0; c < bpp; c++)
+				{
+					int gradient = (x * 255 / w + y * 255 / h + c * 64) & 0xff;
+					row[x * bpp + c] = static_cast<Uint8>(static_cast<Uint32>(gradient) ^ ((noise >> (c * 8)) & 0x1f));
+				}
+			}
+		}
+		return surface;
+	}
+
+	// FNV-1a over the visible pixel bytes and the surface geometry
+	Uint64 surfaceChecksum(const SDL_Surface *surface)
+	{
+		Uint64 hash = 1469598103934665603ull;
+		auto mix = [&hash](Uint8 byte) {
+			hash ^= byte;
+			hash *= 1099511628211ull;
+		};
+		const int values[] = {surface->w, surface->h, surface->format->BitsPerPixel};
+		for (int v : values)
+			for (int i = 0; i < 4; i++)
+				mix(static_cast<Uint8>(v >> (i * 8)));
+
+		const int rowBytes = surface->w * surface->format->BytesPerPixel;
+		for (int y = 0; y < surface->h; y++)
+		{
+			auto row = static_cast<const Uint8 *>(surface->pixels) + y * surface->pitch;
+			for (int i = 0; i < rowBytes; i++)
+				mix(row[i]);
+		}
+		return hash;
+	}
+
+	double fitFactor(const SDL_Surface *surface)
+	{
+		return std::min(static_cast<double>(FIT_W) / surface->w,
+						static_cast<double>(FIT_H) / surface->h);
+	}
+
+	vector<Kernel> createKernels()
+	{
+		return {
+			{"zoom", [](SDL_Surface *s) {
+				 double f = fitFactor(s);
+				 return zoomSurface(s, f, f, SMOOTHING_ON);
+			 }},
+			{"shrink", [](SDL_Surface *s) {
+				 return shrinkSurface(s, 2, 2);
+			 }},
+			{"rotate90", [](SDL_Surface *s) {
+				 return rotateSurface90Degrees(s, 3);
+			 }},
+			{"rotozoom", [](SDL_Surface *s) {
+				 double f = fitFactor(s);
+				 return rotozoomSurfaceXY(s, 270, f, f, SMOOTHING_ON);
+			 }},
+		};
+	}
+
+	double elapsedNs(Uint64 start, Uint64 end)
+	{
+		return static_cast<double>(end - start) * 1e9 /
+			   static_cast<double>(SDL_GetPerformanceFrequency());
+	}
+
+	// run one kernel on one surface and print its result as a JSON object
+	void runCase(const Kernel &kernel, const SurfaceSize &size, int depth, SDL_Surface *src, bool first)
+	{
+		cout << (first ? "" : ",") << endl
+			 << "    {\"kernel\": \"" << kernel.name << "\", \"size\": \"" << size.name
+			 << "\", \"width\": " << size.w << ", \"height\": " << size.h
+			 << ", \"bpp\": " << depth;
+
+		for (int i = 0; i < warmupRuns; i++)
+			SDL_FreeSurface(kernel.run(src));
+
+		vector<double> times;
+		Uint64 checksum = 0;
+		int outW = 0, outH = 0, outBpp = 0;
+		for (int i = 0; i < repeatRuns; i++)
+		{
+			Uint64 start = SDL_GetPerformanceCounter();
+			SDL_Surface *dst = kernel.run(src);
+			Uint64 end = SDL_GetPerformanceCounter();
+			if (dst == nullptr)
+			{
+				cout << ", \"supported\": false}";
+				return;
+			}
+			times.push_back(elapsedNs(start, end));
+			if (i == 0)
+			{
+				checksum = surfaceChecksum(dst);
+				outW = dst->w;
+				outH = dst->h;
+				outBpp = dst->format->BitsPerPixel;
+			}
+			SDL_FreeSurface(dst);
+		}
+
+		std::sort(times.begin(), times.end());
+		double median = times[times.size() / 2];
+		double pixels = static_cast<double>(size.w) * size.h;
+		double bytes = pixels * (depth / 8) + static_cast<double>(outW) * outH * (outBpp / 8);
+
+		char checksumText[32];
+		snprintf(checksumText, sizeof(checksumText), "%016llx", static_cast<unsigned long long>(checksum));
+
+		cout << ", \"supported\": true"
+			 << ", \"out_width\": " << outW << ", \"out_height\": " << outH << ", \"out_bpp\": " << outBpp
+			 << ", \"reps\": " << repeatRuns
+			 << ", \"median_ns\": " << static_cast<long long>(median)
+			 << ", \"min_ns\": " << static_cast<long long>(times.front())
+			 << ", \"ns_per_pixel\": " << median / pixels
+			 << ", \"mb_per_s\": " << bytes / (median / 1e9) / 1e6
+			 << ", \"checksum\": \"" << checksumText << "\"}";
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	handleOptions(argc, argv);
+
+	auto kernels = createKernels();
+
+	cout << "{" << endl
+		 << "  \"warmup\": " << warmupRuns << "," << endl
+		 << "  \"repetitions\": " << repeatRuns << "," << endl
+		 << "  \"results\": [";
+
+	bool first = true;
+	for (const auto &size : sizes)
+	{
+		if (!sizeFilter.empty() && sizeFilter != size.name)
+			continue;
+		for (int depth : depths)
+		{
+			SDL_Surface *src = createSyntheticSurface(size.w, size.h, depth);
+			if (src == nullptr)
+			{
+				cerr << "bench_rotozoom: surface creation failed: " << SDL_GetError() << endl;
+				return 1;
+			}
+			for (const auto &kernel : kernels)
+			{
+				if (!kernelFilter.empty() && kernelFilter != kernel.name)
+					continue;
+				runCase(kernel, size, depth, src, first);
+				first = false;
+			}
+			SDL_FreeSurface(src);
+		}
+	}
+
+	cout << endl
+		 << "  ]" << endl
+		 << "}" << endl;
+
+	return 0;
+}
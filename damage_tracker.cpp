@@ -0,0 +1,44 @@
+#include "damage_tracker.h"
+
+DamageTracker::DamageTracker(int width, int height)
+    : width_(width), height_(height)
+{
+    damage_ = {0, 0, width_, height_};
+    history_.fill(damage_);
+    updateRedrawRect();
+}
+
+void DamageTracker::setBufferAge(int age) {
+    bufferAge_ = age <= maxBufferAge ? age : 0;
+    updateRedrawRect();
+}
+
+void DamageTracker::limitTo(const SDL_Rect &rect) {
+    SDL_Rect screen = {0, 0, width_, height_};
+    if (!SDL_IntersectRect(&rect, &screen, &damage_))
+        damage_ = {0, 0, 0, 0};
+    updateRedrawRect();
+}
+
+void DamageTracker::present() {
+    for (size_t i = history_.size() - 1; i > 0; i--)
+        history_[i] = history_[i - 1];
+    history_[0] = damage_;
+
+    // following frames are fully damaged until limited
+    damage_ = {0, 0, width_, height_};
+    updateRedrawRect();
+}
+
+void DamageTracker::updateRedrawRect() {
+    if (bufferAge_ == 0)
+    {
+        redraw_ = {0, 0, width_, height_};
+        return;
+    }
+
+    // the back buffer misses the damage of the frames presented since it was drawn
+    redraw_ = damage_;
+    for (size_t i = 0; i + 1 < static_cast<size_t>(bufferAge_); i++)
+        SDL_UnionRect(&redraw_, &history_[i], &redraw_);
+}
@@ -0,0 +1,43 @@
+#ifndef DAMAGE_TRACKER_H
+#define DAMAGE_TRACKER_H
+
+#include <array>
+
+#include <SDL.h>
+
+// Keeps track of the screen area changed by each frame, so that a backend
+// which keeps the content of its back buffer only redraws what has changed
+// since that buffer was last drawn.
+//
+// Frames are fully damaged unless they are limited to a smaller area. The
+// buffer age is the number of frames the back buffer lags behind, 1 for a
+// single buffer, 2 when flipping between two pages, and 0 if unknown, like
+// for a window whose back buffer is invalid after each present.
+class DamageTracker
+{
+public:
+    explicit DamageTracker(int width, int height);
+    virtual ~DamageTracker() = default;
+
+    void setBufferAge(int age);
+    // limit the damage of the next frame to rect
+    void limitTo(const SDL_Rect &rect);
+    // area of the back buffer to redraw for the next frame
+    const SDL_Rect &getRedrawRect() const { return redraw_; }
+    bool isPartial() const { return redraw_.w < width_ || redraw_.h < height_; }
+    // record the damage of the frame just presented
+    void present();
+
+private:
+    static const int maxBufferAge = 2;
+
+    void updateRedrawRect();
+
+    int width_, height_;
+    int bufferAge_ = 0;
+    SDL_Rect damage_;   // damage of the next frame
+    SDL_Rect redraw_;
+    std::array<SDL_Rect, maxBufferAge> history_;  // damage of presented frames, most recent first
+};
+
+#endif // DAMAGE_TRACKER_H
@@ -0,0 +1,47 @@
+#include "frame_stats.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <ctime>
+
+FrameStats::FrameStats(const std::string &label, const std::string &unit, double scale)
+    : label_(label), unit_(unit.empty() ? "" : " " + unit), scale_(scale)
+{
+    samples_.reserve(capacity);
+}
+
+void FrameStats::add(double value) {
+    samples_.push_back(value);
+    if (samples_.size() == capacity && !isKeepingAll_)
+        print();
+}
+
+void FrameStats::print() {
+    size_t count = samples_.size();
+    if (count == 0)
+        return;
+
+    // percentiles are taken by rank, the samples are dropped afterwards
+    std::sort(samples_.begin(), samples_.end());
+    double sum = 0;
+    for (double sample : samples_)
+        sum += sample;
+    auto percentile = [count, this](size_t p) { return samples_[(count - 1) * p / 100] * scale_; };
+
+    std::cerr << std::fixed << std::setprecision(2)
+        << label_ << ": " << count << " frames"
+        << ", mean " << sum / static_cast<double>(count) * scale_ << unit_
+        << ", p50 " << percentile(50) << unit_
+        << ", p90 " << percentile(90) << unit_
+        << ", p95 " << percentile(95) << unit_
+        << ", p99 " << percentile(99) << unit_
+        << ", max " << samples_[count - 1] * scale_ << unit_ << std::endl;
+    samples_.clear();
+}
+
+double threadCpuSeconds() {
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_nsec) * 1e-9;
+}
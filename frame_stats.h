@@ -0,0 +1,41 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <vector>
+#include <string>
+
+// Collects a value per frame, like its duration, and prints their
+// distribution to stderr whenever enough frames have been collected.
+// Adding a frame never allocates, so it can be used inside the main loop,
+// unless all frames of a run are kept.
+class FrameStats
+{
+public:
+    // values are printed multiplied by scale, followed by unit
+    explicit FrameStats(const std::string &label, const std::string &unit = "ms",
+        double scale = 1000);
+    virtual ~FrameStats() = default;
+
+    // keep all frames until print is called, so that a whole run
+    // is summarized at once instead of every capacity frames
+    void keepAll() { isKeepingAll_ = true; }
+    // add the value of a frame, durations are in seconds
+    void add(double value);
+    // print the frames collected so far and start over
+    void print();
+
+private:
+    static const size_t capacity = 240;
+
+    std::string label_;
+    std::string unit_;
+    double scale_;
+    std::vector<double> samples_;
+    bool isKeepingAll_ = false;
+};
+
+// CPU time used by the calling thread in seconds,
+// excludes time spent waiting and work of other threads
+double threadCpuSeconds();
+
+#endif // FRAME_STATS_H
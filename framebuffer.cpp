@@ -0,0 +1,135 @@
+#include "framebuffer.h"
+
+#include <iostream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+
+Framebuffer::Framebuffer(const std::string &path, int width, int height)
+    : width_(width), height_(height)
+{
+    std::memset(&varInfo_, 0, sizeof(varInfo_));
+
+    // only a stand-in file is created, a mistyped device path fails
+    bool isDevicePath = path.compare(0, 5, "/dev/") == 0;
+    fd_ = open(path.c_str(), isDevicePath ? O_RDWR : O_RDWR | O_CREAT, 0644);
+    if (fd_ == -1)
+    {
+        std::cerr << "Cannot open framebuffer " << path << std::endl;
+        return;
+    }
+
+    fb_fix_screeninfo fixInfo;
+    if (ioctl(fd_, FBIOGET_VSCREENINFO, &varInfo_) == 0)
+    {
+        isDevice_ = true;
+        if (static_cast<int>(varInfo_.xres) != width || static_cast<int>(varInfo_.yres) != height)
+        {
+            std::cerr << "Framebuffer size is not " << width << "x" << height << std::endl;
+            return;
+        }
+
+        // use the ARGB8888 layout set by fbfixcolor, with room for two pages
+        varInfo_.bits_per_pixel = 32;
+        varInfo_.red.offset = 16;
+        varInfo_.red.length = 8;
+        varInfo_.green.offset = 8;
+        varInfo_.green.length = 8;
+        varInfo_.blue.offset = 0;
+        varInfo_.blue.length = 8;
+        varInfo_.transp.offset = 24;
+        varInfo_.transp.length = 8;
+        varInfo_.yres_virtual = varInfo_.yres * 2;
+        varInfo_.yoffset = 0;
+        if (ioctl(fd_, FBIOPUT_VSCREENINFO, &varInfo_) != 0)
+            std::cerr << "ioctl FBIOPUT_VSCREENINFO failed, drawing without page flipping" << std::endl;
+
+        if (ioctl(fd_, FBIOGET_VSCREENINFO, &varInfo_) != 0 ||
+            ioctl(fd_, FBIOGET_FSCREENINFO, &fixInfo) != 0 ||
+            varInfo_.bits_per_pixel != 32)
+        {
+            std::cerr << "Framebuffer is not 32 bits per pixel" << std::endl;
+            return;
+        }
+        pitch_ = static_cast<int>(fixInfo.line_length);
+        pageCount_ = varInfo_.yres_virtual >= varInfo_.yres * 2 ? 2 : 1;
+        mapSize_ = fixInfo.smem_len;
+    }
+    else
+    {
+        // regular file holding two pages
+        pitch_ = width * 4;
+        pageCount_ = 2;
+        mapSize_ = static_cast<size_t>(pitch_) * static_cast<size_t>(height) * 2;
+        if (ftruncate(fd_, static_cast<off_t>(mapSize_)) != 0)
+        {
+            std::cerr << "Cannot resize framebuffer file " << path << std::endl;
+            return;
+        }
+    }
+
+    void *map = mmap(nullptr, mapSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED)
+    {
+        std::cerr << "Cannot map framebuffer " << path << std::endl;
+        return;
+    }
+    map_ = static_cast<Uint8 *>(map);
+
+    // draw into the page not shown
+    backPage_ = pageCount_ - 1;
+    surface_ = SDL_CreateRGBSurfaceWithFormatFrom(
+        pageAddress(backPage_),
+        width,
+        height,
+        32,
+        pitch_,
+        SDL_PIXELFORMAT_ARGB8888);
+    if (surface_ != nullptr)
+        renderer_ = SDL_CreateSoftwareRenderer(surface_);
+    if (renderer_ == nullptr)
+        std::cerr << "Framebuffer renderer creation failed: " << SDL_GetError() << std::endl;
+}
+
+Framebuffer::~Framebuffer() {
+    if (renderer_ != nullptr)
+        SDL_DestroyRenderer(renderer_);
+    if (surface_ != nullptr)
+        SDL_FreeSurface(surface_);
+    if (map_ != nullptr)
+        munmap(map_, mapSize_);
+    if (fd_ != -1)
+        close(fd_);
+}
+
+Uint8 *Framebuffer::pageAddress(int page) const {
+    return map_ + static_cast<size_t>(pitch_) * static_cast<size_t>(height_) * static_cast<size_t>(page);
+}
+
+void Framebuffer::present() {
+    if (pageCount_ < 2)
+        return;
+
+    // pan to the finished page, the driver shows it from the next vsync
+    if (isDevice_)
+    {
+        varInfo_.yoffset = static_cast<Uint32>(backPage_ * height_);
+        if (ioctl(fd_, FBIOPAN_DISPLAY, &varInfo_) != 0)
+            std::cerr << "ioctl FBIOPAN_DISPLAY failed" << std::endl;
+
+        // the old front page is drawn into next, so wait until the pan
+        // has taken effect, otherwise drawing it may tear the shown frame
+        Uint32 screen = 0;
+        if (isVsyncWait_ && ioctl(fd_, FBIO_WAITFORVSYNC, &screen) != 0)
+        {
+            std::cerr << "ioctl FBIO_WAITFORVSYNC failed, frames may tear" << std::endl;
+            isVsyncWait_ = false;
+        }
+    }
+
+    // the software renderer draws into whatever the surface points to
+    backPage_ = (backPage_ + 1) % pageCount_;
+    surface_->pixels = pageAddress(backPage_);
+}
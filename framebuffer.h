@@ -0,0 +1,55 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <string>
+
+#include <SDL.h>
+#include <linux/fb.h>
+
+// Renders directly into a Linux framebuffer without a window. The framebuffer
+// is mapped into memory, frames are drawn by an SDL software renderer into the
+// back page and shown by panning to it with FBIOPAN_DISPLAY.
+//
+// A regular file outside /dev can stand in for the framebuffer device, it is
+// created if missing and resized to hold two ARGB8888 pages and keeps the
+// last two frames, which is enough for developing and measuring the backend
+// without the device.
+class Framebuffer
+{
+public:
+    explicit Framebuffer(const std::string &path, int width, int height);
+    virtual ~Framebuffer();
+
+    // disallow copying and assignment
+    Framebuffer(const Framebuffer &) = delete;
+    Framebuffer &operator=(const Framebuffer &) = delete;
+
+    bool isOpen() const { return renderer_ != nullptr; }
+    bool isDevice() const { return isDevice_; }
+    SDL_Renderer * getRenderer() const { return renderer_; }
+    // surface of the back page the renderer draws into
+    SDL_Surface * getSurface() const { return surface_; }
+    // frames the back page lags behind, it keeps what was drawn into it
+    int getBufferAge() const { return pageCount_; }
+
+    // show the back page, following frames are drawn into the other page
+    void present();
+
+private:
+    Uint8 * pageAddress(int page) const;
+
+    int width_, height_;
+    int fd_ = -1;
+    bool isDevice_ = false;       // false for a file standing in for the device
+    bool isVsyncWait_ = true;     // the driver supports FBIO_WAITFORVSYNC
+    fb_var_screeninfo varInfo_;
+    Uint8 *map_ = nullptr;
+    size_t mapSize_ = 0;
+    int pitch_ = 0;
+    int pageCount_ = 1;           // 2 when page flipping, 1 draws into the visible page
+    int backPage_ = 0;
+    SDL_Surface *surface_ = nullptr;   // back page, pixels are swapped on present
+    SDL_Renderer *renderer_ = nullptr;
+};
+
+#endif // FRAMEBUFFER_H
@@ -7,4 +7,10 @@ namespace global
 
 	SDL_Renderer *renderer;
 
+	RenderQueue *renderQueue = nullptr;
+
+	bool isRGB565Images = false;
+
+	Uint32 textureFormat = SDL_PIXELFORMAT_UNKNOWN;
+
 } // namespace constants
@@ -3,6 +3,8 @@
 
 #include <SDL.h>
 
+class RenderQueue;
+
 namespace global
 {
     const int SCREEN_WIDTH = 480;
@@ -10,6 +12,16 @@ namespace global
 
     extern SDL_Renderer *renderer;
 
+    // draw commands of the current frame, submitted to renderer in batches
+    extern RenderQueue *renderQueue;
+
+    // store opaque images as dithered RGB565 instead of 32 bit color
+    extern bool isRGB565Images;
+
+    // pixel format of opaque image textures,
+    // SDL_PIXELFORMAT_UNKNOWN creates them in the format of the image
+    extern Uint32 textureFormat;
+
 } // namespace constants
 
 #endif // GLOBAL_H_
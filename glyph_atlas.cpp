@@ -0,0 +1,256 @@
+#include "glyph_atlas.h"
+
+#include <iostream>
+#include <algorithm>
+#include <SDL.h>
+
+#include "global.h"
+#include "render_queue.h"
+
+GlyphAtlas::GlyphAtlas(int pageSize)
+    : pageSize_(pageSize)
+{
+}
+
+const GlyphAtlas::Glyph &GlyphAtlas::getGlyph(TTF_Font *font, Uint32 codepoint) {
+    auto found = glyphs_.find(GlyphKey{font, codepoint});
+    if (found != glyphs_.end())
+        return found->second;
+
+    // rasterize in white, the text color is applied by the vertex color
+    int minx = 0, maxx = 0, miny = 0, maxy = 0, advance = 0;
+    TTF_GlyphMetrics32(font, codepoint, &minx, &maxx, &miny, &maxy, &advance);
+    SDLSurfaceUniquePtr surface {
+        codepoint != ' ' ?
+            TTF_RenderGlyph32_Blended(font, codepoint, SDL_Color{255, 255, 255, 255}) :
+            nullptr
+    };
+    return addGlyph(font, codepoint, surface.get(), minx, advance);
+}
+
+const GlyphAtlas::Glyph &GlyphAtlas::addGlyph(TTF_Font *font, Uint32 codepoint,
+    SDL_Surface *surface, int minx, int advance)
+{
+    GlyphKey key = {font, codepoint};
+    auto found = glyphs_.find(key);
+    if (found != glyphs_.end())
+        return found->second;
+
+    // a glyph rendered alone is shifted right by the
+    // part extending to the left of its origin
+    Glyph glyph = {-1, {0, 0, 0, 0}, std::min(minx, 0), advance};
+    if (surface != nullptr && surface->w > 0 && surface->h > 0 &&
+        allocateRect(surface->w, surface->h, glyph.rect, glyph.page))
+    {
+        SDL_UpdateTexture(getPage(glyph.page), &glyph.rect,
+            surface->pixels, surface->pitch);
+    }
+
+    return glyphs_.emplace(key, glyph).first->second;
+}
+
+bool GlyphAtlas::hasGlyphs(TTF_Font *font, const std::string &text) const {
+    size_t pos = 0;
+    while (pos < text.size())
+    {
+        if (glyphs_.find(GlyphKey{font, nextCodepoint(text, pos)}) == glyphs_.end())
+            return false;
+    }
+    return true;
+}
+
+bool GlyphAtlas::allocateRect(int w, int h, SDL_Rect &rect, int &page) {
+    // glyphs are separated by a transparent pixel,
+    // so that filtering never samples a neighbouring glyph
+    if (w >= pageSize_ || h >= pageSize_)
+        return false;
+
+    // pack glyphs in rows, start a new page when the last one is full
+    if (shelfX_ + w >= pageSize_)
+    {
+        shelfX_ = 0;
+        shelfY_ += shelfHeight_;
+        shelfHeight_ = 0;
+    }
+    if (pages_.empty() || shelfY_ + h >= pageSize_)
+    {
+        if (!addPage())
+            return false;
+    }
+
+    rect = {shelfX_, shelfY_, w, h};
+    page = static_cast<int>(pages_.size()) - 1;
+    shelfX_ += w + 1;
+    shelfHeight_ = std::max(shelfHeight_, h + 1);
+    return true;
+}
+
+bool GlyphAtlas::addPage() {
+    SDLTextureUniquePtr page {
+        SDL_CreateTexture(
+            global::renderer,
+            SDL_PIXELFORMAT_ARGB8888,
+            SDL_TEXTUREACCESS_STATIC,
+            pageSize_,
+            pageSize_)
+    };
+    if (page == nullptr)
+    {
+        std::cerr << ("Glyph atlas page creation failed") << std::endl;
+        return false;
+    }
+
+    // clear page, the gaps between glyphs must be transparent
+    std::vector<Uint32> pixels(static_cast<size_t>(pageSize_) * static_cast<size_t>(pageSize_), 0);
+    SDL_UpdateTexture(page.get(), nullptr, pixels.data(), pageSize_ * 4);
+    SDL_SetTextureBlendMode(page.get(), SDL_BLENDMODE_BLEND);
+
+    pages_.push_back(std::move(page));
+    shelfX_ = 0;
+    shelfY_ = 0;
+    shelfHeight_ = 0;
+    return true;
+}
+
+AtlasText::AtlasText(GlyphAtlas &atlas, TTF_Font *font, SDL_Color color)
+    : atlas_(atlas), font_(font), color_(color)
+{
+}
+
+void AtlasText::setText(const std::string &text, TextTextureAlignment alignment) {
+    text_ = text;
+    quads_.clear();
+
+    // lay out glyphs along the line, same as TTF_RenderUTF8_Blended
+    int pen = 0, right = 0;
+    Uint32 previous = 0;
+    size_t pos = 0;
+    while (pos < text_.size())
+    {
+        Uint32 codepoint = nextCodepoint(text_, pos);
+        if (previous != 0)
+            pen += TTF_GetFontKerningSizeGlyphs32(font_, previous, codepoint);
+
+        const auto &glyph = atlas_.getGlyph(font_, codepoint);
+        if (glyph.page >= 0)
+        {
+            quads_.push_back({glyph.page, glyph.rect, pen + glyph.offsetX});
+            right = std::max(right, pen + glyph.offsetX + glyph.rect.w);
+        }
+        pen += glyph.advance;
+        previous = codepoint;
+    }
+
+    w_ = std::max(pen, right);
+    h_ = TTF_FontHeight(font_);
+    updateTargetRect(alignment);
+
+    // group quads by page, each page is drawn as one batch
+    std::sort(quads_.begin(), quads_.end(), [](const Quad &a, const Quad &b) {
+        return a.page != b.page ? a.page < b.page : a.x < b.x;
+    });
+
+    // rotate by 270 degrees around the text center, the line
+    // runs upwards and the top of the glyphs faces left
+    layout_.clear();
+    float scale = 1.0f / static_cast<float>(atlas_.getPageSize());
+    for (const auto &quad : quads_)
+    {
+        float u0 = static_cast<float>(quad.x) - static_cast<float>(w_) / 2.0f;
+        float u1 = u0 + static_cast<float>(quad.src.w);
+        float v0 = -static_cast<float>(h_) / 2.0f;
+        float v1 = v0 + static_cast<float>(quad.src.h);
+        float s0 = static_cast<float>(quad.src.x) * scale;
+        float s1 = static_cast<float>(quad.src.x + quad.src.w) * scale;
+        float t0 = static_cast<float>(quad.src.y) * scale;
+        float t1 = static_cast<float>(quad.src.y + quad.src.h) * scale;
+
+        layout_.push_back({{v0, -u0}, color_, {s0, t0}});
+        layout_.push_back({{v0, -u1}, color_, {s1, t0}});
+        layout_.push_back({{v1, -u1}, color_, {s1, t1}});
+        layout_.push_back({{v1, -u0}, color_, {s0, t1}});
+    }
+}
+
+void AtlasText::updateTargetRect(TextTextureAlignment alignment) {
+    rect_ = textTargetRect(w_, h_, alignment);
+}
+
+void AtlasText::render() const {
+    float shift = 0;
+    renderCopies(&shift, 1);
+}
+
+void AtlasText::renderMarquee(float offset, float length) const {
+    // the following copy is only drawn once it has entered the screen
+    float shifts[2] = {offset, offset - length};
+    renderCopies(shifts, length - offset < static_cast<float>(global::SCREEN_HEIGHT) ? 2 : 1);
+}
+
+void AtlasText::renderCopies(const float *shifts, int count) const {
+    // center of the text, as for a TextTexture drawn at rect_
+    float cx = static_cast<float>(rect_.x) + static_cast<float>(w_) / 2.0f;
+    float cy = static_cast<float>(rect_.y) + static_cast<float>(h_) / 2.0f;
+
+    // one batch per atlas page, usually there is only one
+    size_t first = 0;
+    while (first < quads_.size())
+    {
+        size_t last = first;
+        while (last < quads_.size() && quads_[last].page == quads_[first].page)
+            last++;
+
+        vertices_.clear();
+        indices_.clear();
+        for (int copy = 0; copy < count; copy++)
+        {
+            for (size_t i = first * 4; i < last * 4; i++)
+            {
+                SDL_Vertex vertex = layout_[i];
+                vertex.position.x += cx;
+                vertex.position.y += cy + shifts[copy];
+                vertex.color = color_;
+                vertices_.push_back(vertex);
+            }
+        }
+        for (int base = 0; base < static_cast<int>(vertices_.size()); base += 4)
+        {
+            for (int index : {0, 1, 2, 0, 2, 3})
+                indices_.push_back(base + index);
+        }
+
+        global::renderQueue->geometry(
+            atlas_.getPage(quads_[first].page),
+            vertices_.data(), static_cast<int>(vertices_.size()),
+            indices_.data(), static_cast<int>(indices_.size())
+        );
+        first = last;
+    }
+}
+
+void AtlasText::scrollLeft(int offset) {
+    rect_.y += offset;
+}
+
+Uint32 nextCodepoint(const std::string &text, size_t &pos) {
+    const Uint32 invalid = 0xFFFD;
+    auto byte = [&text](size_t i) { return static_cast<Uint32>(static_cast<unsigned char>(text[i])); };
+
+    Uint32 c = byte(pos++);
+    if (c < 0x80) return c;
+
+    // number of continuation bytes and the bits of the lead byte
+    int count;
+    if ((c & 0xE0) == 0xC0) { count = 1; c &= 0x1F; }
+    else if ((c & 0xF0) == 0xE0) { count = 2; c &= 0x0F; }
+    else if ((c & 0xF8) == 0xF0) { count = 3; c &= 0x07; }
+    else return invalid;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (pos >= text.size() || (byte(pos) & 0xC0) != 0x80)
+            return invalid;
+        c = (c << 6) | (byte(pos++) & 0x3F);
+    }
+    return c;
+}
@@ -0,0 +1,124 @@
+#ifndef GLYPH_ATLAS_H
+#define GLYPH_ATLAS_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "sdl_unique_ptr.h"
+#include "text_texture.h"
+
+#include <SDL_ttf.h>
+
+// Cache of rasterized glyphs shared by all atlas texts. Each glyph of a font
+// is rendered once and stored in a page of the atlas texture, so that a text
+// can be changed without rendering it with FreeType and uploading a texture.
+class GlyphAtlas
+{
+public:
+    struct Glyph
+    {
+        int page;      // index of atlas page, -1 if the glyph has no pixels
+        SDL_Rect rect; // location in atlas page
+        int offsetX;   // offset of glyph surface from pen position
+        int advance;   // horizontal advance in pixels
+    };
+
+    explicit GlyphAtlas(int pageSize = 1024);
+    virtual ~GlyphAtlas() = default;
+
+    // disallow copying and assignment
+    GlyphAtlas(const GlyphAtlas &) = delete;
+    GlyphAtlas &operator=(const GlyphAtlas &) = delete;
+
+    // get glyph of the code point, it is rasterized on first use
+    const Glyph &getGlyph(TTF_Font *font, Uint32 codepoint);
+    // add a glyph rasterized elsewhere, e.g. by another thread with its own
+    // instance of the font, the surface is nullptr for glyphs without pixels
+    const Glyph &addGlyph(TTF_Font *font, Uint32 codepoint, SDL_Surface *surface,
+        int minx, int advance);
+    // check if all glyphs of a UTF-8 text are cached
+    bool hasGlyphs(TTF_Font *font, const std::string &text) const;
+
+    SDL_Texture * getPage(int page) const { return pages_[static_cast<size_t>(page)].get(); }
+    int getPageSize() const { return pageSize_; }
+
+private:
+    struct GlyphKey
+    {
+        TTF_Font *font;
+        Uint32 codepoint;
+        bool operator==(const GlyphKey &other) const {
+            return font == other.font && codepoint == other.codepoint;
+        }
+    };
+
+    struct GlyphKeyHash
+    {
+        size_t operator()(const GlyphKey &key) const {
+            return std::hash<const void *>()(key.font) ^ (std::hash<Uint32>()(key.codepoint) << 1);
+        }
+    };
+
+    bool allocateRect(int w, int h, SDL_Rect &rect, int &page);
+    bool addPage();
+
+    int pageSize_;
+    int shelfX_ = 0, shelfY_ = 0, shelfHeight_ = 0; // packing position in last page
+    std::vector<SDLTextureUniquePtr> pages_;
+    std::unordered_map<GlyphKey, Glyph, GlyphKeyHash> glyphs_;
+};
+
+// A single line of text drawn from the glyph atlas, as one batch of quads per
+// atlas page. It is placed and rotated the same way as a TextTexture, the
+// rotated vertices are computed once when the text is set.
+class AtlasText
+{
+public:
+    explicit AtlasText(GlyphAtlas &atlas, TTF_Font *font, SDL_Color color);
+    virtual ~AtlasText() = default;
+
+    // disallow copying and assignment
+    AtlasText(const AtlasText &) = delete;
+    AtlasText &operator=(const AtlasText &) = delete;
+
+    void setText(const std::string &text, TextTextureAlignment alignment);
+    void updateTargetRect(TextTextureAlignment alignment);
+    void render() const;
+    // render moved by a fractional offset along the line, together with the
+    // copy following length pixels behind it, in the same batch
+    void renderMarquee(float offset, float length) const;
+    void scrollLeft(int offset);
+    void setAlpha(Uint8 alpha) { color_.a = alpha; }
+
+    int getWidth() const { return w_; }
+    int getHeight() const { return h_; }
+    const std::string &getText() const { return text_; }
+
+private:
+    void renderCopies(const float *shifts, int count) const;
+
+    struct Quad
+    {
+        int page;
+        SDL_Rect src; // location in atlas page
+        int x;        // position along the line
+    };
+
+    GlyphAtlas &atlas_;
+    TTF_Font *font_;
+    SDL_Color color_;
+    std::string text_;
+    int w_ = 0, h_ = 0;
+    SDL_Rect rect_ = {0, 0, 0, 0};
+    std::vector<Quad> quads_;           // sorted by atlas page
+    std::vector<SDL_Vertex> layout_;    // rotated vertices of quads, relative to text center
+    mutable std::vector<SDL_Vertex> vertices_;
+    mutable std::vector<int> indices_;
+};
+
+// decode the UTF-8 code point at pos and advance pos past it,
+// invalid sequences are returned as U+FFFD
+Uint32 nextCodepoint(const std::string &text, size_t &pos);
+
+#endif // GLYPH_ATLAS_H
@@ -5,11 +5,57 @@
 #include <SDL_image.h>
 
 #include "global.h"
+#include "render_queue.h"
 #include "SDL_rotozoom.h"
-#include "fileutils.h"
+#include "SDL_pixelops.h"
 
 using namespace std;
 
+namespace
+{
+    // convert a 32 bit surface to the same layout without alpha channel
+    SDLSurfaceUniquePtr dropAlphaChannel(SDL_Surface *surface)
+    {
+        auto format = surface->format;
+        Uint32 opaqueFormat = SDL_MasksToPixelFormatEnum(
+            32, format->Rmask, format->Gmask, format->Bmask, 0);
+        return SDLSurfaceUniquePtr{
+            SDL_ConvertSurfaceFormat(surface, opaqueFormat, 0)};
+    }
+
+    // convert an opaque surface to dithered RGB565, keeps the original on failure
+    SDLSurfaceUniquePtr ditherToRGB565(SDLSurfaceUniquePtr surface)
+    {
+        if (surface == nullptr)
+            return surface;
+        SDLSurfaceUniquePtr converted{ditherSurfaceRGB565(surface.get())};
+        return converted != nullptr ? std::move(converted) : std::move(surface);
+    }
+
+    // create the texture of an image, opaque images in the selected
+    // texture format if there is one
+    SDLTextureUniquePtr createImageTexture(SDL_Surface *surface, bool opaque)
+    {
+        if (!opaque || global::textureFormat == SDL_PIXELFORMAT_UNKNOWN)
+            return SDLTextureUniquePtr{SDL_CreateTextureFromSurface(global::renderer, surface)};
+
+        SDLSurfaceUniquePtr converted;
+        if (surface->format->format != global::textureFormat)
+        {
+            converted = SDLSurfaceUniquePtr{SDL_ConvertSurfaceFormat(surface, global::textureFormat, 0)};
+            if (converted == nullptr)
+                return nullptr;
+            surface = converted.get();
+        }
+        SDLTextureUniquePtr texture{
+            SDL_CreateTexture(global::renderer, global::textureFormat,
+                SDL_TEXTUREACCESS_STATIC, surface->w, surface->h)};
+        if (texture != nullptr)
+            SDL_UpdateTexture(texture.get(), nullptr, surface->pixels, surface->pitch);
+        return texture;
+    }
+} // namespace
+
 ImageItem::ImageItem(int index, std::string filename, bool rotation)
     : index_(index), filename_(std::move(filename)), rotation_(rotation)
 {
@@ -19,8 +65,7 @@ ImageItem::ImageItem(int index, std::string filename, bool rotation)
 void ImageItem::init()
 {
     loading_ok_ = false;
-
-    description_ = File_utils::getShortFileName(filename_);
+    opaque_ = false;
 }
 
 void ImageItem::loadImage()
@@ -28,20 +73,44 @@ void ImageItem::loadImage()
     if (loading_ok_)
         return;
 
-    if (rotation_) {
-        image_ = SDLSurfaceUniquePtr{
-            loadImageToFit(
-                filename_,
-                global::SCREEN_HEIGHT,
-                global::SCREEN_WIDTH)};
-    } else {
-        image_ = SDLSurfaceUniquePtr{
-            loadImageToFit(
-                filename_,
-                global::SCREEN_WIDTH,
-                global::SCREEN_HEIGHT)};
+    // rotated images are fitted to the rotated screen
+    auto image = rotation_ ?
+        loadImageToFit(filename_, global::SCREEN_HEIGHT, global::SCREEN_WIDTH) :
+        loadImageToFit(filename_, global::SCREEN_WIDTH, global::SCREEN_HEIGHT);
+
+    SDLSurfaceUniquePtr motionImage = nullptr;
+    if (image != nullptr)
+    {
+        // drop the alpha channel of opaque images, so that they can be
+        // rendered without blending
+        opaque_ = surfaceIsOpaque(image.get());
+        if (opaque_ && image->format->Amask != 0)
+            image = dropAlphaChannel(image.get());
+
+        // half resolution copy used while moving
+        motionImage = SDLSurfaceUniquePtr{shrinkSurface(image.get(), 2, 2)};
+
+        // store opaque images in 16 bit color if enabled,
+        // halving memory, texture upload and blit bandwidth
+        if (opaque_ && global::isRGB565Images)
+        {
+            image = ditherToRGB565(std::move(image));
+            motionImage = ditherToRGB565(std::move(motionImage));
+        }
+    }
+
+    if (image != nullptr && rotation_)
+    {
+        // bake the 270 degrees screen rotation into the surface,
+        // so that it can be rendered without RenderCopyEx
+        image = SDLSurfaceUniquePtr{rotateSurface90Degrees(image.get(), 3)};
+        if (motionImage != nullptr)
+            motionImage = SDLSurfaceUniquePtr{rotateSurface90Degrees(motionImage.get(), 3)};
     }
 
+    image_ = std::move(image);
+    motionImage_ = std::move(motionImage);
+
     if (image_ == nullptr)
         cerr << ("Image loading failed: ") << filename_ << endl;
     loading_ok_ = (image_ != nullptr);
@@ -49,11 +118,25 @@ void ImageItem::loadImage()
 
 void ImageItem::createTexture()
 {
-    texture_ = SDLTextureUniquePtr{
-        SDL_CreateTextureFromSurface(global::renderer, image_.get())};
+    texture_ = createImageTexture(image_.get(), opaque_);
 
     if (texture_ == nullptr)
         cerr << ("Texture creation failed") << endl;
+    else if (opaque_)
+        SDL_SetTextureBlendMode(texture_.get(), SDL_BLENDMODE_NONE);
+
+    // the motion texture is upscaled when rendered, nearest sampling is
+    // the cheapest filter and its artifacts are hidden by the movement
+    if (motionImage_ != nullptr)
+    {
+        motionTexture_ = createImageTexture(motionImage_.get(), opaque_);
+        if (motionTexture_ != nullptr)
+        {
+            SDL_SetTextureScaleMode(motionTexture_.get(), SDL_ScaleModeNearest);
+            if (opaque_)
+                SDL_SetTextureBlendMode(motionTexture_.get(), SDL_BLENDMODE_NONE);
+        }
+    }
 }
 
 void ImageItem::render()
@@ -64,47 +147,44 @@ void ImageItem::render()
     render(0, 0);
 }
 
-void ImageItem::render(int x, int y)
+void ImageItem::render(int x, int y, RenderQuality quality, Uint8 alpha)
 {
     if (!loading_ok_)
         return;
 
     if (texture_ == nullptr)
     {
+        // previews are drawn only from textures uploaded earlier
+        if (quality == RenderQuality::preview)
+            return;
         createTexture();
     }
 
     // Rectangle to hold the offsets
-    SDL_Rect dstrect;
-    if (rotation_) {
-        // Set offsets
-        dstrect.x = (global::SCREEN_WIDTH - image_->w) / 2 - 1 + x;
-        dstrect.y = (global::SCREEN_HEIGHT - image_->h) / 2 + y;
-        dstrect.w = image_->w;
-        dstrect.h = image_->h;
-        // Blit the surface
-        SDL_RenderCopyEx(global::renderer, texture_.get(), nullptr,
-                        &dstrect, 270, nullptr, SDL_FLIP_NONE);
-    } else {
-        // Set offsets
-        dstrect.x = (global::SCREEN_WIDTH - image_->w) / 2 - 1 + x;
-        dstrect.y = (global::SCREEN_HEIGHT - image_->h) / 2 + y;
-        dstrect.w = image_->w;
-        dstrect.h = image_->h;
-        // Blit the surface
-        SDL_RenderCopyEx(global::renderer, texture_.get(), nullptr,
-                        &dstrect, 0, nullptr, SDL_FLIP_NONE);
-    }
+    SDL_FRect dstrect;
+    dstrect.x = static_cast<float>((global::SCREEN_WIDTH - image_->w) / 2 - 1 + x);
+    dstrect.y = static_cast<float>((global::SCREEN_HEIGHT - image_->h) / 2 + y);
+    dstrect.w = static_cast<float>(image_->w);
+    dstrect.h = static_cast<float>(image_->h);
+
+    // use the cheaper texture while moving, if available
+    auto texture = texture_.get();
+    if (quality != RenderQuality::full && motionTexture_ != nullptr)
+        texture = motionTexture_.get();
+
+    // Blit the surface, rotation is already baked into the image
+    global::renderQueue->copy(texture, nullptr, dstrect, SDL_Color{255, 255, 255, alpha});
 }
 
-void ImageItem::renderOffset(double offset_x, double offset_y)
+void ImageItem::renderOffset(double offset_x, double offset_y, RenderQuality quality,
+    Uint8 alpha)
 {
     if (!loading_ok_)
         return;
 
     int pos_x = static_cast<int>(offset_x * global::SCREEN_WIDTH);
     int pos_y = static_cast<int>(offset_y * global::SCREEN_HEIGHT);
-    render(pos_x, pos_y);
+    render(pos_x, pos_y, quality, alpha);
 }
 
 SDLSurfaceUniquePtr ImageItem::loadImageToFit(
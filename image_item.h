@@ -5,6 +5,11 @@
 
 #include "sdl_unique_ptr.h"
 
+// full quality is used at rest, motion quality trades detail for speed
+// while the image is moving during an animation, preview quality draws the
+// motion texture only if it already exists and never uploads textures
+enum class RenderQuality { full, motion, preview };
+
 class ImageItem
 {
 public:
@@ -22,18 +27,18 @@ public:
     // render itself at center screen
     void render();
 
-    // render itself at specified position
-    void render(int x, int y);
+    // render itself at specified position, faded by alpha
+    void render(int x, int y, RenderQuality quality = RenderQuality::full,
+        Uint8 alpha = 255);
 
     // render itself at with offset in proportion to screen size,
     // image is centered in screen when offset is zero
-    void renderOffset(double offset_x, double offset_y);
+    void renderOffset(double offset_x, double offset_y,
+        RenderQuality quality = RenderQuality::full, Uint8 alpha = 255);
 
     bool loading_ok_;
     int getIndex() const { return index_; }
-    std::string getFilename() const { return filename_; }
-    void setDescription(std::string description) { description_ = description; }
-    std::string getDescription() const { return description_; }
+    const std::string &getFilename() const { return filename_; }
     SDL_Texture * getTexture() const { return texture_.get(); }
 private:
     void init();
@@ -44,10 +49,12 @@ private:
 
     const int index_;
     const std::string filename_;
-    std::string description_;
     SDLSurfaceUniquePtr image_ = nullptr;
     SDLTextureUniquePtr texture_ = nullptr;
+    SDLSurfaceUniquePtr motionImage_ = nullptr;     // half resolution copy of image
+    SDLTextureUniquePtr motionTexture_ = nullptr;   // nearest filtered texture of motionImage_
     const bool rotation_;
+    bool opaque_;                                   // no translucent pixels, rendered without blending
 };
 
 #endif // IMAGE_ITEM_H_
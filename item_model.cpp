@@ -0,0 +1,197 @@
+#include "item_model.h"
+
+#include <iostream>
+#include <algorithm>
+#include <iterator>
+#include <SDL.h>
+
+namespace
+{
+    // file name without path and extension, as File_utils::getShortFileName
+    std::string_view shortFileName(std::string_view path)
+    {
+        auto name = path.substr(path.rfind('/') + 1);
+        return name.substr(0, name.rfind('.'));
+    }
+}
+
+ItemModel::ItemModel(size_t radius, Uint32 loadedEvent)
+    : radius_(radius), loadedEvent_(loadedEvent)
+{
+    // the window and the items leaving it while they are still on screen
+    slots_.reserve(2 * radius_ + 4);
+    mutex_ = SDL_CreateMutex();
+    cond_ = SDL_CreateCond();
+}
+
+ItemModel::~ItemModel() {
+    if (thread_ != nullptr)
+    {
+        SDL_LockMutex(mutex_);
+        isStopping_ = true;
+        SDL_CondSignal(cond_);
+        SDL_UnlockMutex(mutex_);
+        SDL_WaitThread(thread_, nullptr);
+    }
+    SDL_DestroyCond(cond_);
+    SDL_DestroyMutex(mutex_);
+}
+
+void ItemModel::keepSource(std::unique_ptr<MappedFile> source) {
+    sources_.push_back(std::move(source));
+}
+
+void ItemModel::add(int index, std::string_view filename, bool rotation) {
+    indices_.push_back(index);
+    filenames_.push_back(filename);
+    descriptions_.emplace_back();
+    rotations_.push_back(rotation);
+}
+
+void ItemModel::setDescription(size_t position, std::string_view description) {
+    descriptions_[position] = description;
+}
+
+std::string_view ItemModel::getDescription(size_t position) const {
+    auto description = descriptions_[position];
+    return !description.empty() ? description : shortFileName(filenames_[position]);
+}
+
+void ItemModel::remove(size_t position) {
+    auto erase = [position](auto &entries) {
+        entries.erase(entries.begin() + static_cast<long>(position));
+    };
+    erase(indices_);
+    erase(filenames_);
+    erase(descriptions_);
+    erase(rotations_);
+    if (indices_.empty())
+        return;
+
+    // keep the center on the same entry, the removed item leaves the window
+    if (center_ > position)
+        center_--;
+    setCenter(center_ % indices_.size());
+}
+
+void ItemModel::setCenter(size_t position, bool isLoading) {
+    center_ = position;
+    if (indices_.empty())
+        return;
+
+    SDL_LockMutex(mutex_);
+    for (auto &slot : slots_)
+        slot.second.isInWindow = false;
+    queue_.clear();
+
+    // visit the positions of the window by distance from the center,
+    // 0, +1, -1, +2, -2, ..., the whole list if it is shorter than the window
+    size_t size = indices_.size();
+    size_t count = std::min(size, 2 * radius_ + 1);
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t distance = ((i + 1) / 2) % size;
+        size_t p = i % 2 == 1 ? (position + distance) % size : (position + size - distance) % size;
+
+        // existing items in the window are kept either way
+        auto found = slots_.find(indices_[p]);
+        if (found == slots_.end() && !isLoading && i != 0)
+            continue;
+        auto &slot = found != slots_.end() ? found->second : slots_[indices_[p]];
+        if (slot.item == nullptr)
+            slot.item.reset(new ImageItem(indices_[p], std::string(getFilename(p)), rotations_[p]));
+        slot.isInWindow = true;
+        if (isLoading && !slot.isLoadDone && slot.item.get() != loading_)
+            queue_.push_back(slot.item.get());
+    }
+    SDL_CondSignal(cond_);
+    SDL_UnlockMutex(mutex_);
+
+    if (isSynchronous_ && isLoading)
+        loadQueued();
+}
+
+ImageItem *ItemModel::getItem(size_t position) const {
+    auto found = slots_.find(indices_[position]);
+    return found != slots_.end() ? found->second.item.get() : nullptr;
+}
+
+void ItemModel::trim(std::initializer_list<const ImageItem *> keep) {
+    SDL_LockMutex(mutex_);
+    for (auto it = slots_.begin(); it != slots_.end();)
+    {
+        const ImageItem *item = it->second.item.get();
+        bool isKept = it->second.isInWindow || item == loading_ ||
+            std::find(keep.begin(), keep.end(), item) != keep.end();
+        it = isKept ? std::next(it) : slots_.erase(it);
+    }
+    SDL_UnlockMutex(mutex_);
+}
+
+void ItemModel::startLoader(bool isThreaded) {
+    if (isThreaded && mutex_ != nullptr && cond_ != nullptr)
+    {
+        thread_ = SDL_CreateThread(run, "load_images", this);
+        if (thread_ != nullptr)
+            return;
+        std::cerr << ("Image loader creation failed, images are loaded in place") << std::endl;
+    }
+    isSynchronous_ = true;
+    loadQueued();
+}
+
+int ItemModel::run(void *data) {
+    auto model = static_cast<ItemModel *>(data);
+    while (true)
+    {
+        SDL_LockMutex(model->mutex_);
+        while (model->queue_.empty() && !model->isStopping_)
+            SDL_CondWait(model->cond_, model->mutex_);
+        if (model->isStopping_)
+        {
+            SDL_UnlockMutex(model->mutex_);
+            break;
+        }
+        // the item is not destroyed while it is loading, see trim
+        ImageItem *item = model->queue_.front();
+        model->queue_.erase(model->queue_.begin());
+        model->loading_ = item;
+        SDL_UnlockMutex(model->mutex_);
+
+        model->loadItem(item);
+    }
+    return 0;
+}
+
+void ItemModel::loadQueued() {
+    while (true)
+    {
+        SDL_LockMutex(mutex_);
+        ImageItem *item = queue_.empty() ? nullptr : queue_.front();
+        if (item != nullptr)
+            queue_.erase(queue_.begin());
+        SDL_UnlockMutex(mutex_);
+        if (item == nullptr)
+            break;
+        loadItem(item);
+    }
+}
+
+void ItemModel::loadItem(ImageItem *item) {
+    item->loadImage();
+
+    int index = item->getIndex();
+    SDL_LockMutex(mutex_);
+    loading_ = nullptr;
+    auto found = slots_.find(index);
+    if (found != slots_.end())
+        found->second.isLoadDone = true;
+    SDL_UnlockMutex(mutex_);
+
+    // notify main loop, redraw is needed if the current image was loaded
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = loadedEvent_;
+    event.user.code = index;
+    SDL_PushEvent(&event);
+}
@@ -0,0 +1,105 @@
+#ifndef ITEM_MODEL_H
+#define ITEM_MODEL_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <initializer_list>
+
+#include <SDL.h>
+
+#include "image_item.h"
+#include "mapped_file.h"
+
+// The image list as compact records, with full image items only for a
+// window of positions around the current one. Items entering the window are
+// created and loaded by a worker thread, nearest to the center first, items
+// leaving it are destroyed with their images and textures. Memory use and
+// startup time depend on the window size rather than on the list length.
+//
+// The records are a structure of arrays, their file names and descriptions
+// are views into the list files, which are mapped into memory and kept by
+// the model, so that no string of the list is copied.
+class ItemModel
+{
+public:
+    // radius is the number of items kept on each side of the center,
+    // loadedEvent is pushed to the main thread after each item has been
+    // loaded, with the index of its record as code
+    explicit ItemModel(size_t radius, Uint32 loadedEvent);
+    virtual ~ItemModel();
+
+    // disallow copying and assignment
+    ItemModel(const ItemModel &) = delete;
+    ItemModel &operator=(const ItemModel &) = delete;
+
+    // keep a file the strings of entries are views into, for as long as
+    // the model exists
+    void keepSource(std::unique_ptr<MappedFile> source);
+    // append an entry, its description defaults to the short file name,
+    // the strings must stay valid, see keepSource
+    void add(int index, std::string_view filename, bool rotation);
+    void setDescription(size_t position, std::string_view description);
+    // remove the entry at position, the entries after it move up by one
+    void remove(size_t position);
+
+    size_t size() const { return indices_.size(); }
+    int getIndex(size_t position) const { return indices_[position]; }
+    std::string_view getFilename(size_t position) const { return filenames_[position]; }
+    std::string_view getDescription(size_t position) const;
+
+    // move the window to be centered on position, the items in it that
+    // are not loaded yet are queued for loading. Without loading, only the
+    // item at the center is created and nothing is queued, for passing
+    // over items quickly without decoding them.
+    void setCenter(size_t position, bool isLoading = true);
+    // item at a position inside the window
+    ImageItem * getItem(size_t position) const;
+    // destroy the items outside the window, except the given ones which
+    // are still on screen, called on the main thread which owns the textures
+    void trim(std::initializer_list<const ImageItem *> keep);
+
+    // start loading queued items on a worker thread, or load them in
+    // place on every move of the window when isThreaded is false
+    void startLoader(bool isThreaded);
+
+private:
+    struct Slot
+    {
+        std::unique_ptr<ImageItem> item;
+        bool isInWindow = false;
+        bool isLoadDone = false;  // loading was attempted, successful or not
+    };
+
+    static int run(void *data);
+    void loadItem(ImageItem *item);
+    void loadQueued();
+
+    // entries by position
+    std::vector<int> indices_;                      // position in the original list, starting at 1
+    std::vector<std::string_view> filenames_;
+    std::vector<std::string_view> descriptions_;    // empty for the default description
+    std::vector<bool> rotations_;
+    std::vector<std::unique_ptr<MappedFile>> sources_;
+
+    size_t radius_;
+    Uint32 loadedEvent_;
+    size_t center_ = 0;
+    bool isSynchronous_ = false;
+
+    // materialized items by record index, only changed by the main thread
+    // with mutex_ held, the worker reads it with mutex_ held
+    std::unordered_map<int, Slot> slots_;
+
+    // state shared with the worker, guarded by mutex_
+    SDL_mutex *mutex_ = nullptr;
+    SDL_cond *cond_ = nullptr;
+    SDL_Thread *thread_ = nullptr;
+    bool isStopping_ = false;
+    std::vector<ImageItem *> queue_;    // items to load, nearest to the center first
+    ImageItem *loading_ = nullptr;      // item the worker is loading
+};
+
+#endif // ITEM_MODEL_H
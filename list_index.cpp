@@ -0,0 +1,49 @@
+#include "list_index.h"
+
+#include <cstring>
+
+static_assert(sizeof(ListIndex::Header) == 32, "list index header must not have padding");
+static_assert(sizeof(ListIndex::Entry) == 40, "list index entry must not have padding");
+
+const char ListIndex::magic[8] = {'S', 'W', 'L', 'I', 'S', 'T', '\r', '\n'};
+
+bool ListIndex::isIndex(std::string_view data) {
+    return data.size() >= sizeof(magic) && std::memcmp(data.data(), magic, sizeof(magic)) == 0;
+}
+
+ListIndex::ListIndex(std::string_view data) {
+    // the entries are used in place, so the data must be aligned for them
+    const Header *header = reinterpret_cast<const Header *>(data.data());
+    if (data.size() < sizeof(Header) ||
+        reinterpret_cast<uintptr_t>(data.data()) % alignof(Entry) != 0 ||
+        std::memcmp(header->magic, magic, sizeof(magic)) != 0 ||
+        header->version != currentVersion)
+        return;
+
+    // entries and strings are within data, in this order
+    uint64_t entriesEnd = sizeof(Header) + static_cast<uint64_t>(header->count) * sizeof(Entry);
+    if (header->stringsOffset < entriesEnd || header->stringsOffset > data.size() ||
+        header->stringsSize > data.size() - header->stringsOffset)
+        return;
+
+    auto entries = reinterpret_cast<const Entry *>(data.data() + sizeof(Header));
+    for (uint32_t i = 0; i < header->count; i++)
+    {
+        const Entry &entry = entries[i];
+        if (static_cast<uint64_t>(entry.pathOffset) + entry.pathLength > header->stringsSize ||
+            static_cast<uint64_t>(entry.titleOffset) + entry.titleLength > header->stringsSize)
+            return;
+    }
+
+    entries_ = entries;
+    strings_ = data.data() + header->stringsOffset;
+    count_ = header->count;
+}
+
+std::string_view ListIndex::getPath(size_t i) const {
+    return std::string_view(strings_ + entries_[i].pathOffset, entries_[i].pathLength);
+}
+
+std::string_view ListIndex::getTitle(size_t i) const {
+    return std::string_view(strings_ + entries_[i].titleOffset, entries_[i].titleLength);
+}
@@ -0,0 +1,66 @@
+#ifndef LIST_INDEX_H
+#define LIST_INDEX_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Binary image list compiled from the image and title lists by the listindex
+// tool, so that the switcher maps it and uses it in place instead of parsing
+// and pairing text lines. It holds a header, a table of fixed size entries
+// and the strings they refer to, in the byte order of the machine writing
+// it, which is the device the frontend runs on.
+class ListIndex
+{
+public:
+    static const char magic[8];
+    static const uint32_t currentVersion = 1;
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t count;             // number of entries
+        uint64_t stringsOffset;     // start of the strings, after the entries
+        uint64_t stringsSize;
+    };
+
+    // flags of an entry
+    static const uint32_t noRotation = 1;   // __NO_ROTATE__ was given for the image
+
+    struct Entry
+    {
+        uint32_t pathOffset, pathLength;    // relative to the strings
+        uint32_t titleOffset, titleLength;  // length 0 for the default title
+        uint32_t width, height;             // size of the source image, 0 if unknown
+        uint32_t flags;
+        uint32_t reserved;
+        uint64_t cacheKey;                  // changes with the image file, 0 if it is missing
+    };
+
+    // check if data starts like a list index, it may still be invalid
+    static bool isIndex(std::string_view data);
+
+    // use the list index in data, which must stay valid and unchanged
+    explicit ListIndex(std::string_view data);
+    virtual ~ListIndex() = default;
+
+    // disallow copying and assignment
+    ListIndex(const ListIndex &) = delete;
+    ListIndex &operator=(const ListIndex &) = delete;
+
+    // the header and all entries are within data
+    bool isValid() const { return entries_ != nullptr; }
+    size_t size() const { return count_; }
+    const Entry &getEntry(size_t i) const { return entries_[i]; }
+    std::string_view getPath(size_t i) const;
+    std::string_view getTitle(size_t i) const;
+    bool isRotation(size_t i) const { return (entries_[i].flags & noRotation) == 0; }
+
+private:
+    const Entry *entries_ = nullptr;
+    const char *strings_ = nullptr;
+    size_t count_ = 0;
+};
+
+#endif // LIST_INDEX_H
@@ -0,0 +1,243 @@
+// Compiles the image list and the title list of the switcher into a binary
+// list index, see list_index.h. The switcher maps the index and uses it in
+// place, the frontend runs this tool whenever it writes new lists.
+//
+// The lists are read with the same rules as the switcher reads them: lines
+// are trimmed, empty lines are skipped and __NO_ROTATE__ applies to the next
+// image. The size of each image is read from its file header and a cache key
+// is derived from its path, size and modification time.
+
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <memory>
+#include <iostream>
+#include <sys/stat.h>
+
+#include "list_index.h"
+#include "mapped_file.h"
+
+using std::string;
+using std::string_view;
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::vector;
+
+namespace
+{
+	void printUsage()
+	{
+		cerr << "Usage: listindex image_list title_list index" << endl
+			 << "       listindex -d index" << endl
+			 << "Compile the image and title lists of the switcher into a binary list index," << endl
+			 << "which is passed to the switcher in place of both lists." << endl
+			 << "-d:\tprint the entries of an index, one tab separated line per entry." << endl;
+	}
+
+	uint32_t readBE16(const unsigned char *p) { return (static_cast<uint32_t>(p[0]) << 8) | p[1]; }
+	uint32_t readLE16(const unsigned char *p) { return p[0] | (static_cast<uint32_t>(p[1]) << 8); }
+	uint32_t readBE32(const unsigned char *p) { return (readBE16(p) << 16) | readBE16(p + 2); }
+	uint32_t readLE32(const unsigned char *p) { return readLE16(p) | (readLE16(p + 2) << 16); }
+
+	// find the frame header of a JPEG file, which follows any number of other segments
+	bool readJpegSize(FILE *file, uint32_t &width, uint32_t &height)
+	{
+		unsigned char segment[9];
+		while (fread(segment, 1, 4, file) == 4)
+		{
+			if (segment[0] != 0xff)
+				return false;
+			int marker = segment[1];
+			uint32_t length = readBE16(segment + 2);
+			bool isFrame = marker >= 0xc0 && marker <= 0xcf &&
+				marker != 0xc4 && marker != 0xc8 && marker != 0xcc;
+			if (isFrame)
+			{
+				if (fread(segment + 4, 1, 5, file) != 5)
+					return false;
+				height = readBE16(segment + 5);
+				width = readBE16(segment + 7);
+				return true;
+			}
+			if (length < 2 || fseek(file, static_cast<long>(length) - 2, SEEK_CUR) != 0)
+				return false;
+		}
+		return false;
+	}
+
+	// size of a PNG, JPEG, GIF or BMP image from its file header, 0 for other files
+	void readImageSize(const string &path, uint32_t &width, uint32_t &height)
+	{
+		width = 0;
+		height = 0;
+		FILE *file = fopen(path.c_str(), "rb");
+		if (file == nullptr)
+			return;
+
+		unsigned char header[26] = {0};
+		size_t count = fread(header, 1, sizeof(header), file);
+		if (count >= 24 && memcmp(header, "\x89PNG\r\n\x1a\n", 8) == 0)
+		{
+			width = readBE32(header + 16);
+			height = readBE32(header + 20);
+		}
+		else if (count >= 10 && memcmp(header, "GIF8", 4) == 0)
+		{
+			width = readLE16(header + 6);
+			height = readLE16(header + 8);
+		}
+		else if (count >= 26 && memcmp(header, "BM", 2) == 0)
+		{
+			// bottom-up bitmaps have a negative height
+			width = readLE32(header + 18);
+			height = static_cast<uint32_t>(std::abs(static_cast<int32_t>(readLE32(header + 22))));
+		}
+		else if (count >= 2 && header[0] == 0xff && header[1] == 0xd8 &&
+			fseek(file, 2, SEEK_SET) == 0 && !readJpegSize(file, width, height))
+		{
+			width = 0;
+			height = 0;
+		}
+		fclose(file);
+	}
+
+	// FNV-1a of the path, size and modification time of an image file
+	uint64_t imageCacheKey(const string &path)
+	{
+		struct stat info;
+		if (stat(path.c_str(), &info) != 0)
+			return 0;
+
+		uint64_t hash = 1469598103934665603ull;
+		auto add = [&hash](const void *data, size_t size) {
+			for (size_t i = 0; i < size; i++)
+			{
+				hash ^= static_cast<const unsigned char *>(data)[i];
+				hash *= 1099511628211ull;
+			}
+		};
+		uint64_t fields[3] = {
+			static_cast<uint64_t>(info.st_size),
+			static_cast<uint64_t>(info.st_mtim.tv_sec),
+			static_cast<uint64_t>(info.st_mtim.tv_nsec)
+		};
+		add(path.data(), path.size());
+		add(fields, sizeof(fields));
+		return hash != 0 ? hash : 1;
+	}
+
+	// append a string to the strings of the index, returns its offset
+	uint32_t addString(string &strings, string_view text)
+	{
+		auto offset = static_cast<uint32_t>(strings.size());
+		strings.append(text);
+		return offset;
+	}
+
+	int compile(const char *imageList, const char *titleList, const char *output)
+	{
+		MappedFile images(imageList);
+		MappedFile titles(titleList);
+		if (!images.isOpen() || !titles.isOpen())
+		{
+			cerr << "listindex: cannot open " << (images.isOpen() ? titleList : imageList) << endl;
+			return 1;
+		}
+
+		vector<ListIndex::Entry> entries;
+		string strings;
+		string_view line;
+		bool rotation = true;
+		while (images.nextLine(line))
+		{
+			if (line.empty()) continue;
+			if (line == "__NO_ROTATE__")
+			{
+				rotation = false;
+				continue;
+			}
+
+			ListIndex::Entry entry;
+			memset(&entry, 0, sizeof(entry));
+			string path(line);
+			entry.pathOffset = addString(strings, line);
+			entry.pathLength = static_cast<uint32_t>(line.size());
+			entry.flags = rotation ? 0 : ListIndex::noRotation;
+			readImageSize(path, entry.width, entry.height);
+			entry.cacheKey = imageCacheKey(path);
+			entries.push_back(entry);
+			rotation = true;
+		}
+
+		// titles are paired with images in order, surplus titles are ignored
+		size_t index = 0;
+		while (index < entries.size() && titles.nextLine(line))
+		{
+			if (line.empty()) continue;
+			entries[index].titleOffset = addString(strings, line);
+			entries[index].titleLength = static_cast<uint32_t>(line.size());
+			index++;
+		}
+
+		ListIndex::Header header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, ListIndex::magic, sizeof(header.magic));
+		header.version = ListIndex::currentVersion;
+		header.count = static_cast<uint32_t>(entries.size());
+		header.stringsOffset = sizeof(header) + entries.size() * sizeof(ListIndex::Entry);
+		header.stringsSize = strings.size();
+
+		// write a temporary file and replace the index at once,
+		// a switcher starting meanwhile never sees a partial index
+		string temporary = string(output) + ".tmp";
+		FILE *file = fopen(temporary.c_str(), "wb");
+		bool isWritten = file != nullptr &&
+			fwrite(&header, sizeof(header), 1, file) == 1 &&
+			fwrite(entries.data(), sizeof(ListIndex::Entry), entries.size(), file) == entries.size() &&
+			fwrite(strings.data(), 1, strings.size(), file) == strings.size();
+		if (file != nullptr && fclose(file) != 0)
+			isWritten = false;
+		if (!isWritten || rename(temporary.c_str(), output) != 0)
+		{
+			cerr << "listindex: cannot write " << output << endl;
+			remove(temporary.c_str());
+			return 1;
+		}
+		return 0;
+	}
+
+	int dump(const char *path)
+	{
+		MappedFile file(path);
+		ListIndex index(file.contents());
+		if (!index.isValid())
+		{
+			cerr << "listindex: not a valid list index: " << path << endl;
+			return 1;
+		}
+
+		for (size_t i = 0; i < index.size(); i++)
+		{
+			const auto &entry = index.getEntry(i);
+			char key[20];
+			snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(entry.cacheKey));
+			cout << i + 1 << '\t' << index.getPath(i) << '\t' << index.getTitle(i) << '\t'
+				 << (index.isRotation(i) ? "rotate" : "no_rotate") << '\t'
+				 << entry.width << 'x' << entry.height << '\t' << key << endl;
+		}
+		return 0;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc == 3 && strcmp(argv[1], "-d") == 0)
+		return dump(argv[2]);
+	if (argc == 4)
+		return compile(argv[1], argv[2], argv[3]);
+	printUsage();
+	return 1;
+}
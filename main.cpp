@@ -3,11 +3,11 @@
 #include <unistd.h>
 #include <cstdio>
 #include <cmath>
-#include <list>
+#include <vector>
+#include <memory>
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <algorithm>
+#include <sys/wait.h>
 
 #include <SDL.h>
 #include <SDL_image.h>
@@ -15,46 +15,132 @@
 
 #include "global.h"
 #include "image_item.h"
+#include "item_model.h"
+#include "mapped_file.h"
+#include "list_index.h"
 #include "text_texture.h"
+#include "glyph_atlas.h"
+#include "title_cache.h"
+#include "alloc_counter.h"
+#include "framebuffer.h"
+#include "frame_stats.h"
+#include "render_queue.h"
+#include "damage_tracker.h"
 #include "fileutils.h"
 
 using std::string;
 using std::cout;
 using std::cerr;
 using std::endl;
-using std::list;
+using std::vector;
 
 // settings
-int scrollingFrames = 20; // how many frames used for image scrolling
+const double nominalFrameTime = 0.03; // seconds per frame assumed by frame based options
+double scrollingDuration = 20 * nominalFrameTime; // seconds used for image scrolling
+const double fadingDuration = 13 * nominalFrameTime; // seconds used for fading out removed item
 bool isMultilineTitle = false;
 bool isShowDescription = true;
 bool isSwapLeftRight = false;
 bool isAllowDeletion = true;
 bool isShowItemIndex = true;
 string deleteCommand = "";
-int scrollingSpeed = 4;	  // title scrolling speed in pixel per frame
+string framebufferPath = "";  // framebuffer device or stand-in file rendered to instead of a window
+bool isPrintFrameTimes = false;
+string renderDriverName = "";  // render driver of the window, empty lets SDL choose
+string textureFormatName = ""; // pixel format of opaque image textures, empty keeps the image format
+int scriptedSteps = 0;        // scrolling steps of a headless or benchmark run, 0 for interactive use
+bool isHeadless = false;      // render offscreen without display
+int benchmarkSteps = 0;       // scrolling steps run with each render driver by a benchmark, 0 for none
+int errorExitStatus = 0;      // exit status after an error, nonzero in the processes of a benchmark
+int headlessDumpInterval = 0; // dump every n-th frame of a headless run, 0 dumps none
+int scrollingSpeed = 4;	  // title scrolling speed in pixel per frame of 30 ms
+bool isListIndex = false;     // image list is a binary list index, which includes the titles
+std::unique_ptr<MappedFile> imageListFile; // image list or list index, read once as it may be a pipe
 
 // global variables used in main.cpp
 string programName;
-list<ImageItem *> imageItems;				  // all loaded images
-list<ImageItem *>::iterator currentIter; // iterator point to current image item
+ItemModel *items = nullptr;	// image list, with items materialized around current item
+size_t currentIndex = 0;	// position of current image item in items
 int fontSize = 28;
 SDL_Color text_color = {235, 219, 178, 255};
 SDL_Color delete_mode_text_color = {255, 50, 50, 255};
 TTF_Font *fontInstruction = nullptr;
 TTF_Font *fontTitle = nullptr;
+TTF_Font *fontTitleWorker = nullptr;      // instance of title font used by the title worker thread
 string fontPath = "res/nunwen.ttf";
-SDL_Texture *messageBGTexture = nullptr;
-TextTexture *titleTexture = nullptr;
+const Uint8 overlayAlpha = 160;        // opacity of the message overlay background
+const Uint8 deleteOverlayAlpha = 200;  // opacity of the overlay background in delete mode
+SDL_Texture *staticFrameTexture = nullptr; // render target caching the static layers of a settled frame
+GlyphAtlas *glyphAtlas = nullptr;        // glyphs of the title and index text
+TextTexture *titleTexture = nullptr;      // multiline title
+AtlasText *titleText = nullptr;           // single line title
 TextTexture *instructionTexture = nullptr;
 TextTexture *deleteInstructionTexture = nullptr;
-TextTexture *indexTexture = nullptr;
+AtlasText *indexText = nullptr;
+string indexString;                       // text of indexText
+string descriptionString;                 // description of an item copied from the item list
+TitleCache *titleCache = nullptr;         // titles rendered ahead of time by a worker thread
+const int titlePrefetchRange = 3;         // number of items on each side whose titles are prepared
+const size_t titleCacheCapacity = 16;     // number of multiline title textures kept
+const size_t itemWindowRadius = 8;        // number of items on each side of current item kept loaded
+Uint32 titleReadyEvent = 0;  // user event pushed by the title worker after each title is rendered
+bool isTitleReady = false;   // false while the title of current item is being rendered
 SDL_Rect overlay_bg_render_rect = {0, 0, 0, 0};
 bool isScrollingTitle = false;
 bool isDeleteMode = false;
-int scrollingOffset = 0;  // current title scrolling offset
+double scrollingOffset = 0; // current title scrolling offset in pixels
 int scrollingLength = 0;  // length of scrolling title with space
-int scrollingPause = 10;  // number of frames to pause when text touch left screen boundary
+const double scrollingPause = 10 * nominalFrameTime; // seconds to pause when text touch left screen boundary
+Uint64 scrollingStart = 0;  // performance counter when title scrolling started
+const int browsingInterval = 10;  // milliseconds between browsing updates while a button is held
+Uint32 imageLoadedEvent = 0; // user event pushed by the loader thread after each image is loaded
+int pendingSteps = 0;     // scrolling steps requested by input but not yet applied
+
+// state of the image scrolling animation, driven by the main loop.
+// The target item is always currentItem(), the item it replaces and the one
+// before that stay visible next to it until the animation finishes.
+struct CarouselState
+{
+	bool isAnimating = false;
+	int direction = 0;             // +1 when moving to next items, -1 to previous items
+	double startPosition = 0;      // offset of target item at start, in screen heights
+	Uint64 start = 0;              // performance counter at start
+	ImageItem *from = nullptr;     // item drawn one screen behind the target
+	ImageItem *trail = nullptr;    // item drawn two screens behind the target
+} carousel;
+
+// state of a held scrolling button, holding it browses through the list
+// with increasing speed, showing only previews of the items passed over
+const double holdDelay = 0.4;           // seconds before holding starts browsing
+const double initialBrowseRate = 8;     // items per second when browsing starts
+const double maxBrowseRate = 200;       // items per second, reached after ~5 seconds
+struct HoldState
+{
+	SDL_Keycode key = SDLK_UNKNOWN;  // held button, SDLK_UNKNOWN if none
+	int direction = 0;               // scrolling steps per item passed over
+	Uint64 start = 0;                // performance counter when pressed
+	Uint64 lastUpdate = 0;           // performance counter of last browsing update
+	double stepFraction = 0;         // fraction of a step carried to next update
+	bool isBrowsing = false;
+} hold;
+
+// framebuffer backend, nullptr when rendering through a window
+Framebuffer *framebuffer = nullptr;
+FrameStats frameTimes("frame");      // render and present of main loop frames
+FrameStats presentTimes("present");  // present only
+FrameStats cpuTimes("cpu");          // CPU time of main loop frames in a headless run
+FrameStats drawCallCounts("draw calls", "", 1);        // renderer draw calls per frame
+FrameStats stateChangeCounts("state changes", "", 1);  // texture and blend mode changes per frame
+FrameStats redrawnAreas("redrawn", "%", 100);            // part of the screen redrawn per frame
+
+// screen area changed by each frame, only backends keeping their
+// back buffer redraw less than the whole screen
+DamageTracker damage(global::SCREEN_WIDTH, global::SCREEN_HEIGHT);
+
+// offscreen target of a headless run, which scrolls through the list
+// by synthetic key presses and exits when done
+SDL_Surface *headlessSurface = nullptr;
+int headlessFrame = 0;
 string instructionText = " \u2190/\u2192 Scroll   \u24B6 Load   \u24B7 Exit   \u24CD Settings";
 string shortInstructionText = "\u24B6 Load  \u24B7 Exit  \u24CD Settings";
 string deleteAddonText = "  \u24CE Remove";
@@ -82,20 +168,62 @@ namespace
 		return x < 0.5 ? 8 * x * x * x * x : 1 - pow(-2 * x + 2, 4) / 2;
 	}
 
+	// seconds elapsed since the given performance counter value
+	double secondsSince(Uint64 start)
+	{
+		return static_cast<double>(SDL_GetPerformanceCounter() - start) /
+			static_cast<double>(SDL_GetPerformanceFrequency());
+	}
+
+	// index of the item the given number of steps away, wrapping around the list
+	size_t indexBy(size_t index, int steps)
+	{
+		auto size = static_cast<long>(items->size());
+		long moved = (static_cast<long>(index) + steps) % size;
+		return static_cast<size_t>(moved < 0 ? moved + size : moved);
+	}
+
+	// description of the item at a position, the returned string
+	// keeps its capacity and is only valid until the next call
+	const string &descriptionOf(size_t position)
+	{
+		descriptionString.assign(items->getDescription(position));
+		return descriptionString;
+	}
+
+	// current item is the center of the window, so it always exists
+	ImageItem *currentItem()
+	{
+		return items->getItem(currentIndex);
+	}
+
 	void printUsage()
 	{
 		cout << endl
-			 << "Usage: switcher image_list title_list [-s speed] [-b on|off] [-m on|off] [-t on|off] [-ts speed] [-n on|off] [-d command]" << endl
+			 << "Usage: switcher image_list title_list [-s speed] [-b on|off] [-m on|off] [-t on|off] [-ts speed] [-n on|off] [-c 16|32] [-d command] [-fb device] [-r driver] [-tf format] [-ft on|off] [-hl steps] [-hd n] [-bm steps]" << endl
+			 << "       switcher list_index [options]" << endl
 			 << endl
-			 << "-s:\timage scrolling speed in frames (default is 20), larger value means slower." << endl
+			 << "list_index:\tbinary list compiled from image_list and title_list by the listindex tool." << endl
+			 << "-s:\timage scrolling duration in frames of 30 ms (default is 20), larger value means slower." << endl
 			 << "-b:\tswap left/right buttons for image scrolling (default is off)." << endl
 			 << "-m:\tdisplay title in multiple lines (default is off)." << endl
 			 << "-t:\tdisplay title at start (default is on)." << endl
-			 << "-ts:\ttitle scrolling speed in pixel per frame (default is 4)." << endl
+			 << "-ts:\ttitle scrolling speed in pixel per frame of 30 ms (default is 4)." << endl
 			 << "-n:\tdisplay item index (default is on)." << endl
+			 << "-c:\tcolor depth of opaque images, 16 uses dithered RGB565 to save memory (default is 32)." << endl
 			 << "-d:\tenable item deletion with the deletion command provided (default is disable)." << endl
 			 << "\tUse TITLE in command to take the selected title as input. e.g. \"echo TITLE\"" << endl
 			 << "\tPass \"\" as argument if no command is provided." << endl
+			 << "-fb:\trender into framebuffer device e.g. /dev/fb0 instead of a window," << endl
+			 << "\ta regular file outside /dev is used as a stand-in framebuffer (default is none)." << endl
+			 << "-r:\trender driver of the window, e.g. opengles2 or software (default is chosen by SDL)." << endl
+			 << "-tf:\ttexture format of opaque images, e.g. rgb565 or argb8888 (default is the image format)." << endl
+			 << "-ft:\tprint frame time statistics and the renderer used to stderr (default is off)." << endl
+			 << "-hl:\trun headless without display, scroll the given number of items and exit," << endl
+			 << "\tthe CPU time of each frame is reported (default is 0, not headless)." << endl
+			 << "-hd:\tdump every n-th frame of a headless run as frame_NNNNN.bmp (default is 0, none)." << endl
+			 << "-bm:\tbenchmark every render driver, scroll the given number of items with each" << endl
+			 << "\tand print its frame time statistics (default is 0, no benchmark)." << endl
 			 << "-h,--help\tshow this help message." << endl
 			 << endl
 			 << "Control: Left/Right: Switch games, A: Confirm, B: Cancel, R1: Toggle title" << endl
@@ -111,7 +239,7 @@ namespace
 			cerr << extraMessage;
 		cerr << endl
 			 << endl;
-		exit(0);
+		exit(errorExitStatus);
 	}
 
 	void printErrorUsageAndExit(const char *message, const char *extraMessage = nullptr)
@@ -124,16 +252,117 @@ namespace
 		exit(0);
 	}
 
+	// index of the render driver with the given name, -1 lets SDL choose
+	int renderDriverIndex(const string &name)
+	{
+		if (name.empty())
+			return -1;
+
+		string available;
+		for (int i = 0; i < SDL_GetNumRenderDrivers(); i++)
+		{
+			SDL_RendererInfo info;
+			if (SDL_GetRenderDriverInfo(i, &info) != 0)
+				continue;
+			if (name == info.name)
+				return i;
+			available += string(" ") + info.name;
+		}
+		printErrorAndExit("Unknown render driver, available are:", available.c_str());
+		return -1;
+	}
+
+	// select the texture format of opaque images by name, without the
+	// SDL_PIXELFORMAT_ prefix, among the formats the renderer supports
+	void selectTextureFormat(const string &name)
+	{
+		if (name.empty())
+			return;
+
+		const size_t prefixLength = strlen("SDL_PIXELFORMAT_");
+		string supported;
+		SDL_RendererInfo info;
+		if (SDL_GetRendererInfo(global::renderer, &info) == 0)
+		{
+			for (Uint32 i = 0; i < info.num_texture_formats; i++)
+			{
+				const char *formatName = SDL_GetPixelFormatName(info.texture_formats[i]);
+				if (strlen(formatName) > prefixLength)
+					formatName += prefixLength;
+				if (SDL_strcasecmp(formatName, name.c_str()) == 0)
+				{
+					global::textureFormat = info.texture_formats[i];
+					return;
+				}
+				supported += string(" ") + formatName;
+			}
+		}
+		printErrorAndExit("Texture format not supported by renderer, supported are:", supported.c_str());
+	}
+
+	// report which renderer and texture format are used
+	void printRendererInfo()
+	{
+		SDL_RendererInfo info;
+		if (SDL_GetRendererInfo(global::renderer, &info) != 0)
+			return;
+		cerr << "renderer: " << info.name
+			 << ((info.flags & SDL_RENDERER_ACCELERATED) != 0 ? ", accelerated" : ", software")
+			 << ", image textures "
+			 << (global::textureFormat == SDL_PIXELFORMAT_UNKNOWN ?
+				 "in image format" : SDL_GetPixelFormatName(global::textureFormat))
+			 << endl;
+	}
+
+	// run the scripted scroll sequence with every render driver, each in a
+	// process of its own starting from scratch, only returns in those processes
+	void runBenchmark()
+	{
+		for (int i = 0; i < SDL_GetNumRenderDrivers(); i++)
+		{
+			SDL_RendererInfo info;
+			if (SDL_GetRenderDriverInfo(i, &info) != 0)
+				continue;
+			cerr << "benchmark " << info.name << ":" << endl;
+
+			pid_t pid = fork();
+			if (pid == 0)
+			{
+				// frame time statistics of the whole run are printed when it
+				// exits, a driver which cannot be set up exits with an error
+				renderDriverName = info.name;
+				scriptedSteps = benchmarkSteps;
+				isHeadless = false;
+				framebufferPath = "";
+				isPrintFrameTimes = true;
+				errorExitStatus = 1;
+				for (auto stats : {&frameTimes, &presentTimes, &drawCallCounts, &stateChangeCounts, &redrawnAreas})
+					stats->keepAll();
+				return;
+			}
+			int status = 0;
+			if (pid == -1 || waitpid(pid, &status, 0) == -1 ||
+				!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+				cerr << "benchmark " << info.name << " failed" << endl;
+		}
+		exit(0);
+	}
+
 	void handleOptions(int argc, char *argv[])
 	{
 		programName = File_utils::getFileName(argv[0]);
 
-		// ensuer enough number of arguments
-		if (argc < 3)
+		// ensuer enough number of arguments, a list index replaces both lists
+		if (argc >= 2)
+		{
+			imageListFile.reset(new MappedFile(argv[1]));
+			isListIndex = ListIndex::isIndex(imageListFile->contents());
+		}
+		if (argc < (isListIndex ? 2 : 3))
 			printErrorUsageAndExit("Arguments missing");
 
 		// handle options
-		int i = 3;
+		int i = isListIndex ? 2 : 3;
 		while (i < argc)
 		{
 			auto option = argv[i];
@@ -144,7 +373,7 @@ namespace
 				int s = atoi(argv[i + 1]);
 				if (s <= 0)
 					printErrorUsageAndExit("-s: Invalue scrolling speed");
-				scrollingFrames = s;
+				scrollingDuration = s * nominalFrameTime;
 				i += 2;
 			}
 			else if (strcmp(option, "-b") == 0)
@@ -205,6 +434,18 @@ namespace
 					printErrorUsageAndExit("-m: Invalue option value, expects on/off\n");
 				i += 2;
 			}
+			else if (strcmp(option, "-c") == 0)
+			{
+				if (i == argc - 1)
+					printErrorUsageAndExit("-c: Missing option value");
+				if (strcmp(argv[i + 1], "16") == 0)
+					global::isRGB565Images = true;
+				else if (strcmp(argv[i + 1], "32") == 0)
+					global::isRGB565Images = false;
+				else
+					printErrorUsageAndExit("-c: Invalue option value, expects 16/32\n");
+				i += 2;
+			}
 			else if (strcmp(option, "-d") == 0)
 			{
 				if (i == argc - 1)
@@ -227,6 +468,70 @@ namespace
 				deleteCommand = cmd;
 				i += 2;
 			}
+			else if (strcmp(option, "-fb") == 0)
+			{
+				if (i == argc - 1)
+					printErrorUsageAndExit("-fb: Missing option value");
+				framebufferPath = argv[i + 1];
+				i += 2;
+			}
+			else if (strcmp(option, "-r") == 0)
+			{
+				if (i == argc - 1)
+					printErrorUsageAndExit("-r: Missing option value");
+				renderDriverName = argv[i + 1];
+				i += 2;
+			}
+			else if (strcmp(option, "-tf") == 0)
+			{
+				if (i == argc - 1)
+					printErrorUsageAndExit("-tf: Missing option value");
+				textureFormatName = argv[i + 1];
+				i += 2;
+			}
+			else if (strcmp(option, "-ft") == 0)
+			{
+				if (i == argc - 1)
+					printErrorUsageAndExit("-ft: Missing option value");
+				if (strcmp(argv[i + 1], "on") == 0)
+					isPrintFrameTimes = true;
+				else if (strcmp(argv[i + 1], "off") == 0)
+					isPrintFrameTimes = false;
+				else
+					printErrorUsageAndExit("-ft: Invalue option value, expects on/off\n");
+				i += 2;
+			}
+			else if (strcmp(option, "-hl") == 0)
+			{
+				if (i == argc - 1)
+					printErrorUsageAndExit("-hl: Missing option value");
+				int s = atoi(argv[i + 1]);
+				if (s <= 0)
+					printErrorUsageAndExit("-hl: Invalue number of steps");
+				scriptedSteps = s;
+				isHeadless = true;
+				i += 2;
+			}
+			else if (strcmp(option, "-hd") == 0)
+			{
+				if (i == argc - 1)
+					printErrorUsageAndExit("-hd: Missing option value");
+				int s = atoi(argv[i + 1]);
+				if (s <= 0)
+					printErrorUsageAndExit("-hd: Invalue frame interval");
+				headlessDumpInterval = s;
+				i += 2;
+			}
+			else if (strcmp(option, "-bm") == 0)
+			{
+				if (i == argc - 1)
+					printErrorUsageAndExit("-bm: Missing option value");
+				int s = atoi(argv[i + 1]);
+				if (s <= 0)
+					printErrorUsageAndExit("-bm: Invalue number of steps");
+				benchmarkSteps = s;
+				i += 2;
+			}
 			else if (strcmp(option, "-h") == 0 || strcmp(option, "--help") == 0)
 			{
 				printUsage();
@@ -237,25 +542,19 @@ namespace
 		}
 	}
 
-	void loadImageFiles(const char *filename)
+	// load the entries of the image list, mapped by handleOptions,
+	// the entries are views into it and it is kept by the list
+	void loadImageFiles(std::unique_ptr<MappedFile> file, const char *filename)
 	{
-		// open file
-		std::ifstream file;
-		file.open(filename);
-		
-		if (file.is_open())
+		if (file->isOpen())
 		{
-			string line;
+			std::string_view line;
 			int index = 1;
 			bool rotation = true;
 
-			// iterate all input line
-			while (std::getline(file, line))
+			// iterate all trimmed input lines
+			while (file->nextLine(line))
 			{
-				// trim input line
-				rtrim(line);
-				ltrim(line);
-
 				// skip empty line
 				if (line.empty()) continue;
 
@@ -264,113 +563,118 @@ namespace
 					continue;
 				}
 
-				// create imageItem and add to list
-				imageItems.push_back(new ImageItem(index, line, rotation));
-				
+				// add entry to list, its item is created when it is shown
+				items->add(index, line, rotation);
+
 				// increace index
 				index++;
 
 				// reset rotation flag
 				rotation = true;
 			}
+			items->keepSource(std::move(file));
 		}
 		else
 		{
 			printErrorAndExit("cannot open file: ", filename);
 		}
+	}
 
-		// close file
-		file.close();
+	// load the entries of a binary list index, made by the listindex tool
+	void loadListIndex(std::unique_ptr<MappedFile> file, const char *filename)
+	{
+		if (!file->isOpen())
+			printErrorAndExit("cannot open file: ", filename);
+
+		ListIndex index(file->contents());
+		if (!index.isValid())
+			printErrorAndExit("invalid list index: ", filename);
+
+		// entries without title keep the default description
+		for (size_t i = 0; i < index.size(); i++)
+		{
+			items->add(static_cast<int>(i + 1), index.getPath(i), index.isRotation(i));
+			if (!index.getTitle(i).empty())
+				items->setDescription(i, index.getTitle(i));
+		}
+		items->keepSource(std::move(file));
 	}
 
 	int loadImageDescriptions(const char *filename)
 	{
-		// open file
-		std::ifstream file;
-		file.open(filename);
+		// map file, the descriptions are views into it and it is kept by the list
+		std::unique_ptr<MappedFile> file(new MappedFile(filename));
 
-		if (file.is_open())
+		if (file->isOpen())
 		{
-			string line;
-			auto iter = imageItems.begin();
+			std::string_view line;
+			size_t index = 0;
 
-			// iterate all input line
-			while (std::getline(file, line))
+			// iterate all trimmed input lines
+			while (file->nextLine(line))
 			{
-				// trim input line
-				rtrim(line);
-				ltrim(line);
-
 				// skip empty line
 				if (line.empty()) continue;
 
 				// set description
-				(*iter)->setDescription(line);
+				items->setDescription(index, line);
 
-				// move to next imageItem
-				iter++;
+				// move to next entry
+				index++;
 
 				// exit loop after reading enough lines
-				if (iter == imageItems.end()) break;
+				if (index == items->size()) break;
 			}
+			items->keepSource(std::move(file));
 		}
 		else
 		{
 			printErrorAndExit("cannot open file: ", filename);
 		}
 
-		// close file
-		file.close();
-
-		return 0;
-	}
-
-	int loadAllImages(void *)
-	{
-		auto front = imageItems.begin();
-		auto back = --imageItems.end();
-
-		// load images from both directions,
-		// make sure the images close to the first shown image will be loaded earlier.
-		while (true)
-		{
-			(*front)->loadImage();
-			(*back)->loadImage();
-
-			front++;
-			if (back != imageItems.begin())
-				back--;
-			if (front == imageItems.end())
-				break;
-		}
-
 		return 0;
 	}
 
 	void prepareTextures()
 	{
-		// create message overlay background texture
+		// place message overlay background, it is drawn as a translucent fill
 		int overlay_height = fontSize + fontSize / 2;
-		SDL_Rect overlay_bg_rect = {0, 0, overlay_height, global::SCREEN_HEIGHT};
 		overlay_bg_render_rect.x = 0;//global::SCREEN_WIDTH - overlay_height;
 		overlay_bg_render_rect.y = 0;
 		overlay_bg_render_rect.w = overlay_height;
 		overlay_bg_render_rect.h = global::SCREEN_HEIGHT;
-		SDL_Surface *surfacebg = SDL_CreateRGBSurface(
-			0,
-			overlay_height,
-			global::SCREEN_HEIGHT,
-			32, 0, 0, 0, 0);
-		SDL_FillRect(
-			surfacebg,
-			&overlay_bg_rect,
-			SDL_MapRGB(surfacebg->format, 0, 0, 0));
-		SDL_SetSurfaceBlendMode(surfacebg, SDL_BLENDMODE_BLEND);
-		messageBGTexture = SDL_CreateTextureFromSurface(
-			global::renderer,
-			surfacebg);
-		SDL_SetTextureAlphaMod(messageBGTexture, 160);
-		SDL_FreeSurface(surfacebg);
+
+		// create render target for caching the image, instruction and index
+		// of a settled frame, the frame is drawn directly if not supported
+		if (SDL_RenderTargetSupported(global::renderer))
+		{
+			staticFrameTexture = SDL_CreateTexture(
+				global::renderer,
+				SDL_PIXELFORMAT_ARGB8888,
+				SDL_TEXTUREACCESS_TARGET,
+				global::SCREEN_WIDTH,
+				global::SCREEN_HEIGHT);
+			if (staticFrameTexture != nullptr)
+				SDL_SetTextureBlendMode(staticFrameTexture, SDL_BLENDMODE_NONE);
+		}
+
+		// create glyph atlas and the texts drawn from it, which
+		// only need a glyph lookup per character when they change
+		glyphAtlas = new GlyphAtlas();
+		titleText = new AtlasText(*glyphAtlas, fontTitle, text_color);
+		indexText = new AtlasText(*glyphAtlas, fontInstruction, text_color);
+
+		// create worker preparing the titles around current item
+		titleReadyEvent = SDL_RegisterEvents(1);
+		titleCache = new TitleCache(
+			*glyphAtlas,
+			fontTitle,
+			scriptedSteps > 0 ? nullptr : fontTitleWorker,  // render in place in a scripted run
+			text_color,
+			isMultilineTitle ? global::SCREEN_HEIGHT - 20 : 0,
+			titleCacheCapacity,
+			titleReadyEvent
+		);
 
 		// create texture for instruction text
 		string text = shortInstructionText; //isShowItemIndex ? shortInstructionText : instructionText;
@@ -391,39 +695,34 @@ namespace
 		);
 	}
 
-	void updateMessageTexture(string message)
+	void updateMessageTexture(const string &message)
 	{
-		// create new message text texture
+		// the title is shown once the worker has rendered it,
+		// until then only the background is drawn
+		isScrollingTitle = false;
+		if (!titleCache->isReady(message))
+			titleCache->request(message);
+		isTitleReady = titleCache->isReady(message);
+		if (!isTitleReady) return;
+
+		// take the prepared texture or lay out the text from cached glyphs
 		if (isMultilineTitle)
 		{
-			titleTexture = new TextTexture(
-				message.c_str(),
-				fontTitle,
-				text_color,
-				TextTextureAlignment::topLeft,
-				global::SCREEN_HEIGHT - 20
-			);
+			titleTexture = titleCache->getTexture(message);
 		}
 		else
 		{
-			titleTexture = new TextTexture(
-				message.c_str(),
-				fontTitle,
-				text_color,
-				TextTextureAlignment::topCenter
-			);
+			titleText->setText(message, TextTextureAlignment::topCenter);
 		}
 
 		// initial variables for scrolling title
-		isScrollingTitle = false;
-		if (!isMultilineTitle && titleTexture->getWidth() > global::SCREEN_HEIGHT)
+		if (!isMultilineTitle && titleText->getWidth() > global::SCREEN_HEIGHT)
 		{
 			isScrollingTitle = true;
-			scrollingPause = 10;
 			scrollingOffset = 0;
-			scrollingLength = titleTexture->getWidth() + 40;
-			scrollingLength -= scrollingLength % scrollingSpeed;
-			titleTexture->updateTargetRect(TextTextureAlignment::topLeft);
+			scrollingStart = SDL_GetPerformanceCounter();
+			scrollingLength = titleText->getWidth() + 40;
+			titleText->updateTargetRect(TextTextureAlignment::topLeft);
 		}
 
 		// initial variables for multiline title
@@ -437,29 +736,52 @@ namespace
 	}
 
 	void updateIndexTexture() {
-		// find the index of current item in list
-		// note that this may not be the same as currentItem->getIndex()
-		auto index = imageItems.size();
-		auto iter = imageItems.begin();
-		while (iter != imageItems.end())
-		{
-			if (iter == currentIter) break;
-			index--;
-			iter++;
-		}
-
-		// create texture
-		std::stringstream ss;
-		ss << index << '/' << imageItems.size(); 
-		indexTexture = new TextTexture(
-			ss.str(),
-			fontInstruction,
-			text_color,
-			TextTextureAlignment::bottomRight
-		);
+		// items are counted from the end of the list, which is shown first,
+		// note that this may not be the same as currentItem()->getIndex()
+		auto index = items->size() - currentIndex;
+
+		// update text, the string keeps its capacity between updates
+		char buffer[32];
+		snprintf(buffer, sizeof(buffer), "%zu/%zu", index, items->size());
+		indexString.assign(buffer);
+		indexText->setText(indexString, TextTextureAlignment::bottomRight);
 
 		// shift left 5 pixels
-		indexTexture->scrollLeft(5);
+		indexText->scrollLeft(5);
+	}
+
+	// report allocations made since the start of a main loop iteration, for
+	// checking by hand, nothing is asserted. A scroll allocates a varying
+	// number of objects, as the items entering the window are created, and
+	// iterations which upload a loaded image or a title create textures. Any
+	// other iteration, like a settled frame or a title scrolling step,
+	// should not allocate.
+	void reportAllocations(const alloc_counter::Counts &start, bool isScroll)
+	{
+		auto counts = alloc_counter::get();
+		size_t allocations = counts.allocations - start.allocations;
+		size_t textures = counts.textures - start.textures;
+		if (isScroll)
+			cerr << "scroll: ";
+		else if (textures != 0)
+			cerr << "upload without scroll: ";
+		else if (allocations != 0)
+			cerr << "frame without scroll: ";
+		else
+			return;
+		cerr << allocations << " allocations, " << textures << " textures created" << endl;
+	}
+
+	// queue the message overlay background at rect, a translucent black fill
+	void renderOverlay(const SDL_Rect &rect, Uint8 alpha)
+	{
+		SDL_FRect dst = {
+			static_cast<float>(rect.x),
+			static_cast<float>(rect.y),
+			static_cast<float>(rect.w),
+			static_cast<float>(rect.h)
+		};
+		global::renderQueue->fill(dst, SDL_Color{0, 0, 0, alpha});
 	}
 
 	void renderInstruction()
@@ -474,24 +796,20 @@ namespace
 			// deelete mode - render dimmer background and delete instruction at top of screen
 
 			// render a less transparent background
-			Uint8 old_alpha;
-			SDL_GetTextureAlphaMod(messageBGTexture, &old_alpha);
-			SDL_SetTextureAlphaMod(messageBGTexture, 200);
-			SDL_RenderCopy(global::renderer, messageBGTexture, nullptr, &rect);
-			SDL_SetTextureAlphaMod(messageBGTexture, old_alpha);
+			renderOverlay(rect, deleteOverlayAlpha);
 			// render delete instruction text
 			deleteInstructionTexture->render();
 		}
 		else if (isShowDescription)
 		{
 			// normal case - render background and instruction at top of screen
-			SDL_RenderCopy(global::renderer, messageBGTexture, nullptr, &rect);
+			renderOverlay(rect, overlayAlpha);
 			instructionTexture->render();
-			if (isShowItemIndex) indexTexture->render();
+			if (isShowItemIndex) indexText->render();
 		}
 		else if (isShowItemIndex)
 		{
-			indexTexture->render();
+			indexText->render();
 		}
 	}
 
@@ -499,141 +817,365 @@ namespace
 	{
 		if (!isShowDescription)return;
 
-		SDL_RenderCopy(global::renderer, messageBGTexture, nullptr, &overlay_bg_render_rect);
-		SDL_SetTextureAlphaMod(titleTexture->getTexture(), alpha);
-		titleTexture->render();
-
-		// render the second message if using rolling message
-		if (isScrollingTitle && scrollingLength - scrollingOffset < global::SCREEN_HEIGHT)
+		renderOverlay(overlay_bg_render_rect, overlayAlpha);
+		if (!isTitleReady) return;
+		if (isMultilineTitle)
 		{
-			titleTexture->render(scrollingLength);
+			titleTexture->setAlpha(alpha);
+			titleTexture->render();
+			return;
 		}
+
+		// scrolling title is drawn together with the copy following it
+		titleText->setAlpha(alpha);
+		if (isScrollingTitle)
+			titleText->renderMarquee(static_cast<float>(scrollingOffset), static_cast<float>(scrollingLength));
+		else
+			titleText->render();
+	}
+
+	// seconds since the scrolling title started its current round,
+	// each round is a pause followed by scrolling the full length
+	double scrollingRoundTime()
+	{
+		double speed = scrollingSpeed / nominalFrameTime;
+		double round = scrollingPause + scrollingLength / speed;
+		return fmod(secondsSince(scrollingStart), round);
+	}
+
+	// milliseconds until the scrolling title moves, 0 while it is moving
+	int scrollingWaitTime()
+	{
+		double time = scrollingRoundTime();
+		return time < scrollingPause ? static_cast<int>(ceil((scrollingPause - time) * 1000)) : 0;
+	}
+
+	// update the scrolling title offset from elapsed time, returns true if it moved
+	bool scrollingDescription()
+	{
+		double time = scrollingRoundTime();
+		double offset = time < scrollingPause ? 0 : (time - scrollingPause) * scrollingSpeed / nominalFrameTime;
+		if (offset == scrollingOffset) return false;
+		scrollingOffset = offset;
+		return true;
+	}
+
+	// progress of the scrolling animation from 0 to 1, driven by elapsed time
+	double carouselProgress()
+	{
+		double progress = secondsSince(carousel.start) / scrollingDuration;
+		return progress < 1.0 ? progress : 1.0;
 	}
 
-	void scrollingDescription()
+	// current offset of the target item, in screen heights
+	double carouselPosition()
 	{
-		// pause few frames in the begining
-		if (scrollingPause > 0)
+		return carousel.startPosition * easeInOutQuart(1.0 - carouselProgress());
+	}
+
+	// request the titles of the items around current item, nearest last
+	// as the most recent request is rendered first
+	void prefetchTitles()
+	{
+		for (int distance = titlePrefetchRange; distance > 0; distance--)
 		{
-			scrollingPause--;
-			return;
+			titleCache->request(descriptionOf(indexBy(currentIndex, distance)));
+			titleCache->request(descriptionOf(indexBy(currentIndex, -distance)));
 		}
+	}
+
+	// move current item by the given number of steps without animation,
+	// positive steps move to next items and negative steps to previous items
+	void moveBy(int steps)
+	{
+		currentIndex = indexBy(currentIndex, steps);
 
-		// update offset and texture target y coordinate
-		scrollingOffset += scrollingSpeed;
-		titleTexture->scrollLeft(scrollingSpeed);
+		// items passed over while browsing are not loaded,
+		// the window is loaded where browsing stops, see endHold
+		items->setCenter(currentIndex, !hold.isBrowsing);
 
-		// reset if the text is completely scrolled outside of screen
-		if (scrollingOffset >= scrollingLength)
+		// update new text
+		prefetchTitles();
+		updateMessageTexture(descriptionOf(currentIndex));
+		if (isShowItemIndex) updateIndexTexture();
+	}
+
+	// move current item by the given number of steps with animation. An
+	// animation in flight is retargeted from the position it has reached,
+	// and several steps are animated as a single jump.
+	void scrollBy(int steps, bool showCurrent = true)
+	{
+		if (steps == 0) return;
+		int direction = steps > 0 ? 1 : -1;
+
+		double position = carousel.isAnimating ? carouselPosition() : 0;
+		if (!carousel.isAnimating || direction == carousel.direction)
 		{
-			scrollingPause = 10;
-			scrollingOffset = 0;
-			titleTexture->updateTargetRect(TextTextureAlignment::topLeft);
+			// keep moving, the previous target becomes the item behind the new one
+			carousel.trail = carousel.isAnimating ? carousel.from : nullptr;
+			carousel.startPosition = position + direction;
 		}
+		else
+		{
+			// turn back, the new target takes the place of the item behind
+			carousel.trail = nullptr;
+			carousel.startPosition = position - carousel.direction;
+		}
+		carousel.from = showCurrent ? currentItem() : nullptr;
+		carousel.direction = direction;
+		carousel.start = SDL_GetPerformanceCounter();
+		carousel.isAnimating = true;
+
+		moveBy(steps);
+	}
+
+	// apply the steps collected from queued input as one jump
+	void applyPendingSteps()
+	{
+		scrollBy(pendingSteps);
+		pendingSteps = 0;
+	}
+
+	void beginHold(SDL_Keycode key, int direction)
+	{
+		hold.key = key;
+		hold.direction = direction;
+		hold.start = SDL_GetPerformanceCounter();
+		hold.isBrowsing = false;
+	}
+
+	// stop browsing, returns true if the screen needs a redraw
+	bool endHold()
+	{
+		bool wasBrowsing = hold.isBrowsing;
+		hold.key = SDLK_UNKNOWN;
+		hold.direction = 0;
+		hold.isBrowsing = false;
+
+		// load the item where browsing stopped first, then the ones around it
+		if (wasBrowsing) items->setCenter(currentIndex);
+		return wasBrowsing;
 	}
 
-	void scrollRight(bool showCurrent = true)
+	// browse through the list while a scrolling button is held,
+	// returns true if current item has changed
+	bool updateHold()
 	{
-		// get current and previous images
-		auto prevIter = currentIter;
-		prevIter = (prevIter != imageItems.begin()) ? --prevIter : --(imageItems.end());
-		ImageItem *curr = *currentIter;
-		ImageItem *prev = *prevIter;
+		if (hold.direction == 0) return false;
 
-		// update new text first
-		updateMessageTexture(prev->getDescription());
+		double held = secondsSince(hold.start);
+		if (held < holdDelay) return false;
 
-		// scroll images
-		double offset = 0;
-		double step = 1.0 / scrollingFrames;
-		for (int i = 0; i < scrollingFrames; i++)
+		// start browsing, the scrolling animation is replaced by previews
+		Uint64 now = SDL_GetPerformanceCounter();
+		if (!hold.isBrowsing)
 		{
-			double easing = easeInOutQuart(offset);
-			SDL_RenderClear(global::renderer);
-			if (showCurrent) curr->renderOffset(0, easing);
-			prev->renderOffset(0, easing - 1);
-			int text_alpha = static_cast<int>((i * 255.0) / scrollingFrames);
-			renderTitle(text_alpha);
-			renderInstruction();
-			offset += step;
-			SDL_RenderPresent(global::renderer);
-			SDL_Delay(30);
+			hold.isBrowsing = true;
+			hold.lastUpdate = now;
+			hold.stepFraction = 1; // pass the first item immediately
+			carousel.isAnimating = false;
+			carousel.from = nullptr;
+			carousel.trail = nullptr;
 		}
-		prev->renderOffset(0, 0);
-		renderTitle(255);
-		renderInstruction();
-		SDL_RenderPresent(global::renderer);
 
-		// update iterator
-		currentIter = prevIter;
-		if (isShowItemIndex) updateIndexTexture();
+		// browsing speed doubles every second
+		double rate = std::min(maxBrowseRate, initialBrowseRate * pow(2.0, held - holdDelay));
+		hold.stepFraction += rate * secondsSince(hold.lastUpdate);
+		hold.lastUpdate = now;
+
+		int steps = static_cast<int>(hold.stepFraction);
+		if (steps == 0) return false;
+		hold.stepFraction -= steps;
+		moveBy(steps * hold.direction);
+		return true;
 	}
 
-	void scrollLeft(bool showCurrent = true)
+	// state shown by the static layers of a settled frame,
+	// the cached frame is rebuilt whenever it changes
+	struct StaticFrameState
 	{
-		// get current and next images
-		auto nextIter = currentIter;
-		nextIter++;
-		if (nextIter == imageItems.end())
-			nextIter = imageItems.begin();
-		ImageItem *curr = *currentIter;
-		ImageItem *next = *nextIter;
+		int index = 0;	// index of item, as items are destroyed outside the window
+		bool isLoaded = false;
+		bool isDeleteMode = false;
+		bool isShowDescription = false;
+		size_t itemCount = 0;
+
+		bool operator==(const StaticFrameState &other) const
+		{
+			return index == other.index && isLoaded == other.isLoaded &&
+				isDeleteMode == other.isDeleteMode &&
+				isShowDescription == other.isShowDescription &&
+				itemCount == other.itemCount;
+		}
+	};
 
-		// update new text first
-		updateMessageTexture(next->getDescription());
+	StaticFrameState cachedFrameState;
+	bool isStaticFrameCached = false;
 
-		// scroll images
-		double offset = 1.0;
-		double step = 1.0 / scrollingFrames;
-		for (int i = 0; i < scrollingFrames; i++)
+	StaticFrameState currentStaticFrameState()
+	{
+		StaticFrameState state;
+		state.index = currentItem()->getIndex();
+		state.isLoaded = currentItem()->loading_ok_;
+		state.isDeleteMode = isDeleteMode;
+		state.isShowDescription = isShowDescription;
+		state.itemCount = items->size();
+		return state;
+	}
+
+	// render image, instruction and index of a settled frame from the cached
+	// render target, which is only redrawn when one of them has changed
+	void renderStaticFrame()
+	{
+		if (staticFrameTexture == nullptr)
 		{
-			double easing = easeInOutQuart(offset);
+			currentItem()->renderOffset(0, 0);
+			renderInstruction();
+			return;
+		}
+
+		auto state = currentStaticFrameState();
+		if (!isStaticFrameCached || !(state == cachedFrameState))
+		{
+			global::renderQueue->flush();
+			SDL_SetRenderTarget(global::renderer, staticFrameTexture);
 			SDL_RenderClear(global::renderer);
-			if (showCurrent) curr->renderOffset(0, easing - 1);
-			next->renderOffset(0, easing);
-			int text_alpha = static_cast<int>((i * 255.0) / scrollingFrames);
-			renderTitle(text_alpha);
+			currentItem()->renderOffset(0, 0);
 			renderInstruction();
-			offset -= step;
-			SDL_RenderPresent(global::renderer);
-			SDL_Delay(30);
+			global::renderQueue->flush();
+			SDL_SetRenderTarget(global::renderer, nullptr);
+			cachedFrameState = state;
+			isStaticFrameCached = true;
 		}
-		next->renderOffset(0, 0);
-		renderTitle(255);
-		renderInstruction();
+		SDL_FRect screen = {0, 0, global::SCREEN_WIDTH, global::SCREEN_HEIGHT};
+		global::renderQueue->copy(staticFrameTexture, nullptr, screen, SDL_Color{255, 255, 255, 255});
+	}
+
+	// show the rendered frame, on the window or by flipping framebuffer pages
+	void presentFrame()
+	{
+		global::renderQueue->flush();
+		Uint64 start = SDL_GetPerformanceCounter();
 		SDL_RenderPresent(global::renderer);
+		if (framebuffer != nullptr) framebuffer->present();
+		if (isPrintFrameTimes)
+		{
+			presentTimes.add(secondsSince(start));
+			const auto &rect = damage.getRedrawRect();
+			redrawnAreas.add(static_cast<double>(rect.w * rect.h) /
+				(global::SCREEN_WIDTH * global::SCREEN_HEIGHT));
+		}
+		damage.present();
+	}
 
-		// update iterator
-		currentIter = nextIter;
-		if (isShowItemIndex) updateIndexTexture();
+	// press and release the scrolling button for the next step of a headless
+	// or benchmark run once the previous step has finished, exit after the last
+	void driveScript()
+	{
+		if (carousel.isAnimating) return;
+		if (scriptedSteps == 0)
+		{
+			if (isHeadless) cpuTimes.print();
+			exit(0);
+		}
+		scriptedSteps--;
+
+		SDL_Event event;
+		SDL_zero(event);
+		event.key.keysym.sym = SDLK_RIGHT;
+		event.type = SDL_KEYDOWN;
+		SDL_PushEvent(&event);
+		event.type = SDL_KEYUP;
+		SDL_PushEvent(&event);
+	}
+
+	// write the frame just rendered in a headless run if it is selected
+	void dumpHeadlessFrame()
+	{
+		if (headlessDumpInterval == 0 || headlessFrame % headlessDumpInterval != 0)
+			return;
+		char filename[32];
+		snprintf(filename, sizeof(filename), "frame_%05d.bmp", headlessFrame);
+		if (SDL_SaveBMP(headlessSurface, filename) != 0)
+			cerr << "Cannot write " << filename << endl;
+	}
+
+	// render current state of screen, including the scrolling animation
+	void renderFrame()
+	{
+		// a partial frame is only drawn over the cached static frame,
+		// the renderer ignores the clip rect when clearing
+		if (!damage.isPartial() || staticFrameTexture == nullptr)
+			SDL_RenderClear(global::renderer);
+		if (hold.isBrowsing)
+		{
+			// only show items already uploaded while browsing
+			currentItem()->renderOffset(0, 0, RenderQuality::preview);
+			renderTitle(255);
+		}
+		else if (carousel.isAnimating)
+		{
+			double position = carouselPosition();
+			double behind = position - carousel.direction;
+			double trailing = position - 2 * carousel.direction;
+			currentItem()->renderOffset(0, position, RenderQuality::motion);
+			if (carousel.from != nullptr && std::abs(behind) < 1.0)
+				carousel.from->renderOffset(0, behind, RenderQuality::motion);
+			if (carousel.trail != nullptr && std::abs(trailing) < 1.0)
+				carousel.trail->renderOffset(0, trailing, RenderQuality::motion);
+			renderTitle(static_cast<Uint8>(carouselProgress() * 255.0));
+		}
+		else
+		{
+			// one full screen copy plus the title, only the damaged part
+			// of it when the back buffer holds the rest of the frame
+			bool isPartial = damage.isPartial() && staticFrameTexture != nullptr;
+			if (isPartial) SDL_RenderSetClipRect(global::renderer, &damage.getRedrawRect());
+			renderStaticFrame();
+			renderTitle(255);
+			presentFrame();
+			if (isPartial) SDL_RenderSetClipRect(global::renderer, nullptr);
+			return;
+		}
+		renderInstruction();
+		presentFrame();
 	}
 
 	void removeCurrentItem()
 	{
-		// fade out current item
-		Uint8 old_alpha;
-		auto texture = (*currentIter)->getTexture();
-		SDL_GetTextureAlphaMod(texture, &old_alpha);
-		for (int alpha = 255; alpha >= 0; alpha-=20)
+		// stop scrolling animation, the fade starts from the target item
+		carousel.isAnimating = false;
+
+		// fade out current item, opaque images are rendered without
+		// blending and need it enabled for the alpha modulation
+		SDL_BlendMode old_blend_mode;
+		auto texture = currentItem()->getTexture();
+		SDL_GetTextureBlendMode(texture, &old_blend_mode);
+		SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+		Uint64 start = SDL_GetPerformanceCounter();
+		double progress = 0;
+		while (progress < 1.0)
 		{
-			SDL_SetTextureAlphaMod(texture, alpha);
-			(*currentIter)->renderOffset(0, 0);
-			SDL_RenderPresent(global::renderer);
-			SDL_Delay(30);
+			SDL_RenderClear(global::renderer);
+			currentItem()->renderOffset(0, 0, RenderQuality::full,
+				static_cast<Uint8>((1.0 - progress) * 255.0));
+			presentFrame();
+			progress = secondsSince(start) / fadingDuration;
 		}
-		SDL_SetTextureAlphaMod(texture, old_alpha);
+		SDL_SetTextureBlendMode(texture, old_blend_mode);
 
-		// get current iterator
-		auto iter = currentIter;
+		// get current index
+		auto removed = currentIndex;
 
 		// if no more item in list after removing current item, exit with value 0
-		if (imageItems.size() == 1) exit(0);
+		if (items->size() == 1) exit(0);
 
 		// scroll the next item without showing the current item
-		scrollRight(false);
+		scrollBy(-1, false);
 
-		// remove current item from list
-		imageItems.remove(*iter);
+		// remove current item from list, the items after it move up by one
+		items->remove(removed);
+		if (currentIndex > removed) currentIndex--;
 
 		// update index for display
 		if (isShowItemIndex) updateIndexTexture();
@@ -670,6 +1212,12 @@ namespace
 		if (event.type != SDL_KEYDOWN)
 			return;
 		const auto sym = event.key.keysym.sym;
+
+		// scrolling input is collected and applied as one jump, other
+		// buttons must see the item the collected steps lead to
+		if (sym != SDLK_LEFT && sym != SDLK_RIGHT)
+			applyPendingSteps();
+
 		switch (sym)
 		{
 		// button A (Space key)
@@ -677,24 +1225,28 @@ namespace
 			if (isDeleteMode) {
 				// delete mode: remove current item when A is pressed
 				isDeleteMode = false; // reset flag to end delete mode
-				int currentIndex = (*currentIter)->getIndex(); // get title of current item first
+				int currentIndex = currentItem()->getIndex(); // get title of current item first
 				runDeleteCommand(currentIndex);
 				removeCurrentItem();
 			}
 			else {
 				// normal case: exit and return index of current item 
-				exit((*currentIter)->getIndex());
+				exit(currentItem()->getIndex());
 			}
 			break;
 		// button LEFT (Left arrow key)
 		case SDLK_LEFT:
 			if (isDeleteMode) return; // disable in delete mode
-			if (isSwapLeftRight) scrollRight(); else scrollLeft();
+			if (event.key.repeat) return; // holding is handled by updateHold
+			pendingSteps += isSwapLeftRight ? -1 : 1;
+			beginHold(sym, isSwapLeftRight ? -1 : 1);
 			break;
 		// button RIGHT (Right arrow key)
 		case SDLK_RIGHT:
 			if (isDeleteMode) return; // disable in delete mode
-			if (isSwapLeftRight) scrollLeft(); else scrollRight();
+			if (event.key.repeat) return; // holding is handled by updateHold
+			pendingSteps += isSwapLeftRight ? 1 : -1;
+			beginHold(sym, isSwapLeftRight ? 1 : -1);
 			break;
 		// button X (Left Shift key)
 		case SDLK_LSHIFT:
@@ -707,6 +1259,7 @@ namespace
 			if (isDeleteMode) return; // disable in delete mode
 			isDeleteMode = true;
 			isShowDescription = true; // ensure instruction & title is shown
+			endHold(); // stop browsing, delete mode disables scrolling
 			break;
 		// button R1 (Backspace key)
 		case SDLK_BACKSPACE:
@@ -735,6 +1288,25 @@ int main(int argc, char *argv[])
 	// handle CLI options
 	handleOptions(argc, argv);
 
+	// a benchmark only continues in the processes running each render driver
+	if (benchmarkSteps > 0)
+		runBenchmark();
+
+	// print the frames not yet reported when exiting
+	if (isPrintFrameTimes)
+		atexit([] {
+			frameTimes.print();
+			presentTimes.print();
+			drawCallCounts.print();
+			stateChangeCounts.print();
+			redrawnAreas.print();
+		});
+
+	// Use the dummy video driver without display when headless,
+	// unless another one like offscreen is asked for
+	if (isHeadless)
+		SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+
 	// Init SDL
 	SDL_Init(SDL_INIT_VIDEO | SDL_INIT_JOYSTICK);
 	if (IMG_Init(IMG_INIT_JPG | IMG_INIT_PNG | IMG_INIT_TIF | IMG_INIT_WEBP) == 0)
@@ -753,76 +1325,237 @@ int main(int argc, char *argv[])
 
 	fontInstruction = TTF_OpenFont(fontPath.c_str(), fontSize);
 	fontTitle = TTF_OpenFont(fontPath.c_str(), fontSize + 4);
+	fontTitleWorker = TTF_OpenFont(fontPath.c_str(), fontSize + 4);
 	if (fontInstruction == nullptr || fontTitle == nullptr)
 		printErrorAndExit("Font loading failed: ", TTF_GetError());
 
 	// Hide cursor before creating the output surface.
 	SDL_ShowCursor(SDL_DISABLE);
 
-	// Create window and renderer
-	SDL_Window *window = SDL_CreateWindow("Main", 0, 0, global::SCREEN_WIDTH, global::SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
-	global::renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_PRESENTVSYNC);
+	// Create window and renderer, or render into the framebuffer without a window
+	SDL_Window *window = nullptr;
+	if (isHeadless)
+	{
+		headlessSurface = SDL_CreateRGBSurfaceWithFormat(
+			0, global::SCREEN_WIDTH, global::SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+		if (headlessSurface != nullptr)
+			global::renderer = SDL_CreateSoftwareRenderer(headlessSurface);
+	}
+	else if (framebufferPath.empty())
+	{
+		// frames of a benchmark are not paced by vsync
+		window = SDL_CreateWindow("Main", 0, 0, global::SCREEN_WIDTH, global::SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
+		if (window == nullptr)
+			printErrorAndExit("Window creation failed: ", SDL_GetError());
+		global::renderer = SDL_CreateRenderer(window, renderDriverIndex(renderDriverName),
+			benchmarkSteps > 0 ? 0 : SDL_RENDERER_PRESENTVSYNC);
+	}
+	else
+	{
+		framebuffer = new Framebuffer(framebufferPath, global::SCREEN_WIDTH, global::SCREEN_HEIGHT);
+		global::renderer = framebuffer->getRenderer();
+	}
 	if (global::renderer == nullptr)
 		printErrorAndExit("Renderer creation failed");
+	global::renderQueue = new RenderQueue();
+	selectTextureFormat(textureFormatName);
+	if (isPrintFrameTimes) printRendererInfo();
+	if (headlessSurface != nullptr)
+	{
+		damage.setBufferAge(1);
+		global::renderQueue->setSoftwareSurface(headlessSurface);
+	}
+	else if (framebuffer != nullptr)
+	{
+		damage.setBufferAge(framebuffer->getBufferAge());
+		global::renderQueue->setSoftwareSurface(framebuffer->getSurface());
+	}
 
 	prepareTextures();
 
-	// load all image filenames and create imageItem instances
-	loadImageFiles(argv[1]);
-	if (imageItems.size() == 0)
+	// load all image filenames and titles, image items
+	// are only created for the window around current item
+	imageLoadedEvent = SDL_RegisterEvents(1);
+	items = new ItemModel(itemWindowRadius, imageLoadedEvent);
+	if (isListIndex)
+		loadListIndex(std::move(imageListFile), argv[1]);
+	else
+		loadImageFiles(std::move(imageListFile), argv[1]);
+	if (items->size() == 0)
 		printErrorAndExit("Cannot load image list");
+	if (!isListIndex)
+		loadImageDescriptions(argv[2]);
 
-	// load all image titles
-	loadImageDescriptions(argv[2]);
+	// set current image as last image in list
+	currentIndex = items->size() - 1;
+	items->setCenter(currentIndex);
 
 	// load first texture
-	imageItems.back()->loadImage();
-	imageItems.back()->createTexture();
+	currentItem()->loadImage();
+	currentItem()->createTexture();
 
-	// load all other image fiies in background thread
-	SDL_CreateThread(loadAllImages, "load_images", nullptr);
-
-	// set current image as last image in list
-	currentIter = --imageItems.end();
+	// load the other images of the window in background thread,
+	// or in place whenever it moves for a reproducible scripted run
+	items->startLoader(scriptedSteps == 0);
 
 	// create title text texture and index texture
-	updateMessageTexture((*currentIter)->getDescription());
+	prefetchTitles();
+	updateMessageTexture(descriptionOf(currentIndex));
 	if (isShowItemIndex) updateIndexTexture();
 
-	// Execute main loop of the window
+	// Execute main loop of the window,
+	// the screen is only redrawn when something on it has changed
+	bool needsRedraw = true;
+	bool needsTitleRedraw = false;  // only the scrolling title has changed
+	const bool isScriptedRun = scriptedSteps > 0;
+	bool wasTitleAnimating = false;
 	while (true)
 	{
+		// state at start of this iteration, used by the allocation counter build
+		auto iterationCounts = alloc_counter::get();
+		size_t iterationIndex = currentIndex;
+
+		// a scripted run renders every iteration without waiting
+		if (isScriptedRun)
+		{
+			driveScript();
+			needsRedraw = true;
+		}
+
+		// wait for input, or until the next animation frame or title scrolling step is due
+		bool isTitleAnimating = isScrollingTitle && isShowDescription && !carousel.isAnimating;
+		if (isTitleAnimating && !wasTitleAnimating)
+		{
+			// start from the beginning when the title shows again
+			scrollingOffset = 0;
+			scrollingStart = SDL_GetPerformanceCounter();
+		}
+		wasTitleAnimating = isTitleAnimating;
+		int timeout = -1;
+		if (carousel.isAnimating || isScriptedRun)
+		{
+			timeout = 0;
+		}
+		else if (hold.direction != 0)
+		{
+			timeout = browsingInterval;
+		}
+		else if (isTitleAnimating)
+		{
+			// sleep through the pause, then render every frame while moving
+			timeout = scrollingWaitTime();
+		}
+
 		// handle input events
 		SDL_Event event;
-		while (SDL_PollEvent(&event))
+		bool hasEvent = SDL_WaitEventTimeout(&event, timeout) != 0;
+		while (hasEvent)
 		{
 			switch (event.type)
 			{
 			case SDL_KEYDOWN:
 				keyPress(event);
+				needsRedraw = true;
+				break;
+			case SDL_KEYUP:
+				if (event.key.keysym.sym == hold.key && endHold())
+					needsRedraw = true;
+				break;
+			case SDL_WINDOWEVENT:
+				needsRedraw = true;
+				break;
+			case SDL_RENDER_TARGETS_RESET:
+			case SDL_RENDER_DEVICE_RESET:
+				// content of the cached frame is lost
+				isStaticFrameCached = false;
+				needsRedraw = true;
 				break;
 			case SDL_QUIT:
 				return 0;
 				break;
+			default:
+				// show the title of current item once it is rendered
+				if (event.type == titleReadyEvent)
+				{
+					titleCache->processResults();
+					if (!isTitleReady)
+					{
+						updateMessageTexture(descriptionOf(currentIndex));
+						if (isTitleReady) needsRedraw = true;
+					}
+				}
+				if (event.type == imageLoadedEvent && event.user.code == currentItem()->getIndex())
+					needsRedraw = true;
+				break;
 			}
+			hasEvent = SDL_PollEvent(&event) != 0;
 		}
 
-		// render current image and title
-		(*currentIter)->renderOffset(0, 0);
-		if (isScrollingTitle) scrollingDescription();
-		renderTitle(255);
-		renderInstruction();
-		SDL_RenderPresent(global::renderer);
+		// start or retarget scrolling with all input collected above
+		applyPendingSteps();
+
+		// browse through the list while a scrolling button is held
+		if (updateHold()) needsRedraw = true;
+
+		// keep rendering while scrolling, and a last frame when it settles
+		if (carousel.isAnimating)
+		{
+			needsRedraw = true;
+			if (carouselProgress() >= 1.0)
+			{
+				carousel.isAnimating = false;
+				carousel.from = nullptr;
+				carousel.trail = nullptr;
+			}
+		}
+
+		// free the items which left the window and are no longer on screen
+		items->trim({carousel.from, carousel.trail});
+
+		// move scrolling title by elapsed time
+		if (isTitleAnimating && scrollingDescription()) needsTitleRedraw = true;
 
-		// delay for around 30 fps
-		SDL_Delay(30);
+		// render current image and title, presents are paced by vsync
+		if (needsRedraw || needsTitleRedraw)
+		{
+			if (!needsRedraw) damage.limitTo(overlay_bg_render_rect);
+			needsRedraw = false;
+			needsTitleRedraw = false;
+			Uint64 frameStart = SDL_GetPerformanceCounter();
+			double cpuStart = threadCpuSeconds();
+			global::renderQueue->resetCounters();
+			renderFrame();
+			if (isPrintFrameTimes)
+			{
+				frameTimes.add(secondsSince(frameStart));
+				drawCallCounts.add(global::renderQueue->getCounters().drawCalls);
+				stateChangeCounts.add(global::renderQueue->getCounters().stateChanges);
+			}
+			if (headlessSurface != nullptr)
+			{
+				cpuTimes.add(threadCpuSeconds() - cpuStart);
+				dumpHeadlessFrame();
+				headlessFrame++;
+			}
+		}
+
+		if (alloc_counter::isEnabled)
+			reportAllocations(iterationCounts, currentIndex != iterationIndex);
 	}
 
 	// the lines below should never reach, just for code completeness
-	SDL_DestroyTexture(messageBGTexture);
-	SDL_DestroyRenderer(global::renderer);
+	SDL_DestroyTexture(staticFrameTexture);
+	delete titleCache;
+	delete items;
+	delete glyphAtlas;
+	delete global::renderQueue;
+	if (framebuffer != nullptr)
+		delete framebuffer;
+	else
+		SDL_DestroyRenderer(global::renderer);
 	TTF_CloseFont(fontInstruction);
 	TTF_CloseFont(fontTitle);
+	TTF_CloseFont(fontTitleWorker);
 	SDL_DestroyWindow(window);
 	SDL_Quit();
 	return 0;
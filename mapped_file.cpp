@@ -0,0 +1,76 @@
+#include "mapped_file.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace
+{
+    // same characters as std::isspace in the C locale
+    inline bool isSpace(char c)
+    {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+}
+
+MappedFile::MappedFile(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        return;
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+    {
+        // the whole file is read, so its pages are mapped at once instead
+        // of faulting them in one by one, the mapping stays valid after
+        // the descriptor is closed
+        size_t size = static_cast<size_t>(info.st_size);
+        void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        if (map != MAP_FAILED)
+        {
+            data_ = static_cast<const char *>(map);
+            size_ = size;
+            isMapped_ = true;
+            isOpen_ = true;
+        }
+    }
+    if (!isMapped_)
+    {
+        // pipes, files without size and files which cannot be mapped
+        // are read into a buffer
+        char chunk[4096];
+        ssize_t count;
+        while ((count = read(fd, chunk, sizeof(chunk))) > 0)
+            buffer_.append(chunk, static_cast<size_t>(count));
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+        isOpen_ = count == 0;
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (isMapped_)
+        munmap(const_cast<char *>(data_), size_);
+}
+
+bool MappedFile::nextLine(std::string_view &line) {
+    if (pos_ >= size_)
+        return false;
+
+    // find the end of the line with memchr, which is vectorized by the C library
+    const char *start = data_ + pos_;
+    auto newline = static_cast<const char *>(std::memchr(start, '\n', size_ - pos_));
+    const char *end = newline != nullptr ? newline : data_ + size_;
+    pos_ = static_cast<size_t>(end - data_) + 1;
+
+    // trim by moving the bounds of the view
+    while (start != end && isSpace(*start))
+        start++;
+    while (end != start && isSpace(end[-1]))
+        end--;
+    line = std::string_view(start, static_cast<size_t>(end - start));
+    return true;
+}
@@ -0,0 +1,40 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <string_view>
+
+// A text file mapped read-only into memory and read line by line. Lines are
+// views into the mapping, with surrounding white space trimmed off, so that
+// reading a file neither copies nor allocates. The views stay valid as long
+// as the file exists. Files which cannot be mapped, like pipes, are read
+// into a buffer instead.
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string &path);
+    virtual ~MappedFile();
+
+    // disallow copying and assignment
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool isOpen() const { return isOpen_; }
+    size_t size() const { return size_; }
+    // whole contents of the file
+    std::string_view contents() const { return std::string_view(data_, size_); }
+
+    // get the next line without leading and trailing white space,
+    // returns false at the end of the file
+    bool nextLine(std::string_view &line);
+
+private:
+    bool isOpen_ = false;
+    bool isMapped_ = false;
+    const char *data_ = nullptr;    // mapping or buffer_
+    size_t size_ = 0;
+    std::string buffer_;            // contents of a file which is not mapped
+    size_t pos_ = 0;                // start of the next line
+};
+
+#endif // MAPPED_FILE_H
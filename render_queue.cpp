@@ -0,0 +1,174 @@
+#include "render_queue.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "global.h"
+#include "SDL_composite.h"
+
+namespace
+{
+    bool intersects(const SDL_FRect &a, const SDL_FRect &b)
+    {
+        return a.x < b.x + b.w && b.x < a.x + a.w &&
+            a.y < b.y + b.h && b.y < a.y + a.h;
+    }
+
+    SDL_FRect unite(const SDL_FRect &a, const SDL_FRect &b)
+    {
+        float x = std::min(a.x, b.x);
+        float y = std::min(a.y, b.y);
+        return SDL_FRect{x, y,
+            std::max(a.x + a.w, b.x + b.w) - x,
+            std::max(a.y + a.h, b.y + b.h) - y};
+    }
+}
+
+void RenderQueue::copy(SDL_Texture *texture, const SDL_Rect *src, const SDL_FRect &dst,
+    SDL_Color color)
+{
+    // texture coordinates of the source rect
+    int w = 1, h = 1;
+    SDL_QueryTexture(texture, nullptr, nullptr, &w, &h);
+    SDL_Rect rect = src != nullptr ? *src : SDL_Rect{0, 0, w, h};
+    float s0 = static_cast<float>(rect.x) / static_cast<float>(w);
+    float s1 = static_cast<float>(rect.x + rect.w) / static_cast<float>(w);
+    float t0 = static_cast<float>(rect.y) / static_cast<float>(h);
+    float t1 = static_cast<float>(rect.y + rect.h) / static_cast<float>(h);
+
+    SDL_Vertex vertices[4] = {
+        {{dst.x, dst.y}, color, {s0, t0}},
+        {{dst.x + dst.w, dst.y}, color, {s1, t0}},
+        {{dst.x + dst.w, dst.y + dst.h}, color, {s1, t1}},
+        {{dst.x, dst.y + dst.h}, color, {s0, t1}}
+    };
+    const int indices[6] = {0, 1, 2, 0, 2, 3};
+    geometry(texture, vertices, 4, indices, 6);
+}
+
+void RenderQueue::fill(const SDL_FRect &dst, SDL_Color color) {
+    SDL_Vertex vertices[4] = {
+        {{dst.x, dst.y}, color, {0, 0}},
+        {{dst.x + dst.w, dst.y}, color, {0, 0}},
+        {{dst.x + dst.w, dst.y + dst.h}, color, {0, 0}},
+        {{dst.x, dst.y + dst.h}, color, {0, 0}}
+    };
+    const int indices[6] = {0, 1, 2, 0, 2, 3};
+    geometry(nullptr, vertices, 4, indices, 6);
+}
+
+void RenderQueue::geometry(SDL_Texture *texture, const SDL_Vertex *vertices, int vertexCount,
+    const int *indices, int indexCount)
+{
+    if (vertexCount == 0 || indexCount == 0)
+        return;
+    counters_.commands++;
+
+    // screen area covered by the command
+    float minX = vertices[0].position.x, maxX = minX;
+    float minY = vertices[0].position.y, maxY = minY;
+    for (int i = 1; i < vertexCount; i++)
+    {
+        minX = std::min(minX, vertices[i].position.x);
+        maxX = std::max(maxX, vertices[i].position.x);
+        minY = std::min(minY, vertices[i].position.y);
+        maxY = std::max(maxY, vertices[i].position.y);
+    }
+
+    Batch &batch = batchFor(texture, SDL_FRect{minX, minY, maxX - minX, maxY - minY});
+    int base = static_cast<int>(batch.vertices.size());
+    batch.vertices.insert(batch.vertices.end(), vertices, vertices + vertexCount);
+    for (int i = 0; i < indexCount; i++)
+        batch.indices.push_back(base + indices[i]);
+}
+
+RenderQueue::Batch &RenderQueue::batchFor(SDL_Texture *texture, const SDL_FRect &bounds) {
+    // look for a batch of the same texture, the command can move before
+    // the batches queued after it as long as it does not overlap them
+    for (size_t i = batchCount_; i-- > 0;)
+    {
+        Batch &batch = batches_[i];
+        if (batch.texture == texture)
+        {
+            batch.bounds = unite(batch.bounds, bounds);
+            return batch;
+        }
+        if (intersects(batch.bounds, bounds))
+            break;
+    }
+
+    // start a new batch, reusing the buffers of an earlier frame
+    if (batchCount_ == batches_.size())
+        batches_.emplace_back();
+    Batch &batch = batches_[batchCount_++];
+    batch.texture = texture;
+    batch.bounds = bounds;
+    batch.vertices.clear();
+    batch.indices.clear();
+    return batch;
+}
+
+void RenderQueue::flush() {
+    for (size_t i = 0; i < batchCount_; i++)
+    {
+        const Batch &batch = batches_[i];
+        if (batch.texture == nullptr && blendFills(batch))
+            continue;
+
+        // untextured triangles are blended by the draw blend mode
+        SDL_BlendMode blendMode = SDL_BLENDMODE_BLEND;
+        if (batch.texture != nullptr)
+            SDL_GetTextureBlendMode(batch.texture, &blendMode);
+        else
+            SDL_SetRenderDrawBlendMode(global::renderer, blendMode);
+        if (batch.texture != lastTexture_ || blendMode != lastBlendMode_)
+            counters_.stateChanges++;
+        lastTexture_ = batch.texture;
+        lastBlendMode_ = blendMode;
+
+        SDL_RenderGeometry(global::renderer,
+            batch.texture,
+            batch.vertices.data(), static_cast<int>(batch.vertices.size()),
+            batch.indices.data(), static_cast<int>(batch.indices.size())
+        );
+        counters_.drawCalls++;
+    }
+    batchCount_ = 0;
+}
+
+bool RenderQueue::blendFills(const Batch &batch) {
+    // only the screen is a surface that can be drawn into directly
+    if (surface_ == nullptr || SDL_GetRenderTarget(global::renderer) != nullptr)
+        return false;
+
+    // finish the commands queued before the fills, and keep to the clip rect
+    SDL_RenderFlush(global::renderer);
+    SDL_Rect clip = {0, 0, surface_->w, surface_->h};
+    if (SDL_RenderIsClipEnabled(global::renderer))
+        SDL_RenderGetClipRect(global::renderer, &clip);
+    SDL_SetClipRect(surface_, &clip);
+
+    // each fill is a quad, its first and third vertex are opposite corners
+    for (size_t i = 0; i + 3 < batch.vertices.size(); i += 4)
+    {
+        const SDL_Vertex &first = batch.vertices[i];
+        const SDL_Vertex &opposite = batch.vertices[i + 2];
+        int x = static_cast<int>(std::lround(first.position.x));
+        int y = static_cast<int>(std::lround(first.position.y));
+        SDL_Rect rect = {
+            x,
+            y,
+            static_cast<int>(std::lround(opposite.position.x)) - x,
+            static_cast<int>(std::lround(opposite.position.y)) - y
+        };
+        const SDL_Color &color = first.color;
+        fillBlendSurface(surface_, &rect, SDL_MapRGB(surface_->format, color.r, color.g, color.b), color.a);
+    }
+    return true;
+}
+
+void RenderQueue::resetCounters() {
+    counters_ = Counters();
+    lastTexture_ = nullptr;
+    lastBlendMode_ = SDL_BLENDMODE_INVALID;
+}
@@ -0,0 +1,73 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <vector>
+
+#include <SDL.h>
+
+// Collects the draw commands of a frame and submits them as few
+// SDL_RenderGeometry calls as possible. A command joins an earlier batch of
+// the same texture when it does not overlap anything queued after that
+// batch, so merging never changes what ends up on screen.
+//
+// Opacity and color are carried by the vertex colors, textures drawn through
+// the queue keep their color and alpha modulation at 255.
+//
+// On a software renderer drawing to the screen, filled rects are blended
+// into its surface by the SDL_composite kernels instead of the renderer.
+class RenderQueue
+{
+public:
+    struct Counters
+    {
+        int commands = 0;      // draw commands queued
+        int drawCalls = 0;     // draw calls submitted to the renderer
+        int stateChanges = 0;  // texture or blend mode changes between draw calls
+    };
+
+    RenderQueue() = default;
+    virtual ~RenderQueue() = default;
+
+    // disallow copying and assignment
+    RenderQueue(const RenderQueue &) = delete;
+    RenderQueue &operator=(const RenderQueue &) = delete;
+
+    // queue a copy of the src rect of a texture, the whole texture if src
+    // is nullptr, modulated by color
+    void copy(SDL_Texture *texture, const SDL_Rect *src, const SDL_FRect &dst, SDL_Color color);
+    // queue a rect filled with color, blended by its alpha
+    void fill(const SDL_FRect &dst, SDL_Color color);
+    // queue triangles, indices refer to the given vertices, plain
+    // colored rects are queued with fill instead of a nullptr texture
+    void geometry(SDL_Texture *texture, const SDL_Vertex *vertices, int vertexCount,
+        const int *indices, int indexCount);
+    // submit all queued commands, needed before changing the render target
+    void flush();
+
+    // surface a software renderer draws the screen into, nullptr otherwise
+    void setSoftwareSurface(SDL_Surface *surface) { surface_ = surface; }
+
+    const Counters &getCounters() const { return counters_; }
+    void resetCounters();
+
+private:
+    struct Batch
+    {
+        SDL_Texture *texture;
+        SDL_FRect bounds;   // screen area covered by the batch
+        std::vector<SDL_Vertex> vertices;
+        std::vector<int> indices;
+    };
+
+    Batch &batchFor(SDL_Texture *texture, const SDL_FRect &bounds);
+    bool blendFills(const Batch &batch);
+
+    std::vector<Batch> batches_;   // batches beyond batchCount_ are kept for reuse
+    size_t batchCount_ = 0;
+    Counters counters_;
+    SDL_Surface *surface_ = nullptr;
+    SDL_Texture *lastTexture_ = nullptr;   // state of the last draw call
+    SDL_BlendMode lastBlendMode_ = SDL_BLENDMODE_INVALID;
+};
+
+#endif // RENDER_QUEUE_H
@@ -5,8 +5,10 @@
 #include <SDL_image.h>
 
 #include "global.h"
+#include "render_queue.h"
+#include "SDL_rotozoom.h"
 
-TextTexture::TextTexture(std::string text, TTF_Font *font, SDL_Color color, 
+TextTexture::TextTexture(const std::string &text, TTF_Font *font, SDL_Color color, 
     TextTextureAlignment alignment)
     : text_(text)
 {
@@ -31,7 +33,7 @@ TextTexture::TextTexture(std::string text, TTF_Font *font, SDL_Color color,
     updateTargetRect(alignment);
 } 
 
-TextTexture::TextTexture(std::string text, TTF_Font *font, SDL_Color color, 
+TextTexture::TextTexture(const std::string &text, TTF_Font *font, SDL_Color color, 
     TextTextureAlignment alignment, unsigned int wrapLength)
     : text_(text)
 {
@@ -57,71 +59,103 @@ TextTexture::TextTexture(std::string text, TTF_Font *font, SDL_Color color,
     updateTargetRect(alignment);
 } 
 
+TextTexture::TextTexture(const std::string &text, SDL_Surface *surface,
+    TextTextureAlignment alignment)
+    : text_(text)
+{
+    // init width and height
+    w_ = surface->w;
+    h_ = surface->h;
+
+    // create texture from the surface rendered by caller
+    createTexture(surface);
+
+    // compute render rect
+    updateTargetRect(alignment);
+}
+
 void TextTexture::createTexture(SDL_Surface *surface) {
-   texture_ = SDLTextureUniquePtr {
+    // rotate once by 270 degrees, so that rendering is a plain copy
+    SDLSurfaceUniquePtr rotated { rotateSurface90Degrees(surface, 3) };
+    if (rotated == nullptr)
+    {
+        std::cerr << ("Text rotation failed") << std::endl;
+        return;
+    }
+
+    texture_ = SDLTextureUniquePtr {
         SDL_CreateTextureFromSurface(
             global::renderer,
-            surface)
+            rotated.get())
     };
     if (texture_ == nullptr)
         std::cerr << ("Texture creation failed") << std::endl;
 }
 
-void TextTexture::updateTargetRect(TextTextureAlignment alignment) {
-    rect_ = {0, 0, 0, 0};
-    rect_.w = w_;
-    rect_.h = h_;
+SDL_Rect textTargetRect(int w, int h, TextTextureAlignment alignment) {
+    SDL_Rect rect = {0, 0, 0, 0};
+    rect.w = w;
+    rect.h = h;
     switch (alignment) {
         case TextTextureAlignment::topCenter:
-            rect_.x = -(w_ - h_) / 2;
-            rect_.y = (global::SCREEN_HEIGHT - h_) / 2;
+            rect.x = -(w - h) / 2;
+            rect.y = (global::SCREEN_HEIGHT - h) / 2;
         break;
         case TextTextureAlignment::topLeft:
-            rect_.x = -(w_ - h_) / 2;
-            rect_.y = (global::SCREEN_HEIGHT - h_) / 2 + 
-                (global::SCREEN_HEIGHT - w_) / 2;
+            rect.x = -(w - h) / 2;
+            rect.y = (global::SCREEN_HEIGHT - h) / 2 + 
+                (global::SCREEN_HEIGHT - w) / 2;
         break;
         case TextTextureAlignment::topRight:
-            rect_.x = -(w_ - h_) / 2;
-            rect_.y = (global::SCREEN_HEIGHT - h_) / 2 - 
-                (global::SCREEN_HEIGHT - w_) / 2;
+            rect.x = -(w - h) / 2;
+            rect.y = (global::SCREEN_HEIGHT - h) / 2 - 
+                (global::SCREEN_HEIGHT - w) / 2;
         break;
         case TextTextureAlignment::bottomCenter:
-            rect_.x = (global::SCREEN_WIDTH - w_) + (w_ - h_) / 2;
-            rect_.y = (global::SCREEN_HEIGHT - h_) / 2;
+            rect.x = (global::SCREEN_WIDTH - w) + (w - h) / 2;
+            rect.y = (global::SCREEN_HEIGHT - h) / 2;
         break;
         case TextTextureAlignment::bottomLeft:
-            rect_.x = (global::SCREEN_WIDTH - w_) + (w_ - h_) / 2;
-            rect_.y = (global::SCREEN_HEIGHT - h_) / 2 +
-            	(global::SCREEN_HEIGHT - w_) / 2;
+            rect.x = (global::SCREEN_WIDTH - w) + (w - h) / 2;
+            rect.y = (global::SCREEN_HEIGHT - h) / 2 +
+            	(global::SCREEN_HEIGHT - w) / 2;
         break;
         case TextTextureAlignment::bottomRight:
-            rect_.x = (global::SCREEN_WIDTH - w_) + (w_ - h_) / 2;
-            rect_.y = (global::SCREEN_HEIGHT - h_) / 2 -
-                (global::SCREEN_HEIGHT - w_) / 2;
+            rect.x = (global::SCREEN_WIDTH - w) + (w - h) / 2;
+            rect.y = (global::SCREEN_HEIGHT - h) / 2 -
+                (global::SCREEN_HEIGHT - w) / 2;
         break;
     }
+    return rect;
+}
+
+void TextTexture::updateTargetRect(TextTextureAlignment alignment) {
+    // the rotated texture covers the target rect turned around its center
+    auto rect = textTargetRect(w_, h_, alignment);
+    rect_.x = rect.x + (w_ - h_) / 2;
+    rect_.y = rect.y + (h_ - w_) / 2;
+    rect_.w = h_;
+    rect_.h = w_;
 }
 
 
 void TextTexture::render() const {
-    SDL_RenderCopyEx(global::renderer, 
-        texture_.get(), 
-        nullptr, 
-        &rect_,
-        270, nullptr, SDL_FLIP_NONE
-    );
+    render(0.0f);
 }
 
-void TextTexture::render(int offsetX) const {
-    auto rect = rect_;
-    rect.y -= offsetX;
+void TextTexture::render(float offsetX) const {
+    SDL_FRect rect = {
+        static_cast<float>(rect_.x),
+        static_cast<float>(rect_.y) - offsetX,
+        static_cast<float>(rect_.w),
+        static_cast<float>(rect_.h)
+    };
 
-    SDL_RenderCopyEx(global::renderer, 
-        texture_.get(), 
-        nullptr, 
-        &rect,
-        270, nullptr, SDL_FLIP_NONE
+    global::renderQueue->copy(
+        texture_.get(),
+        nullptr,
+        rect,
+        SDL_Color{255, 255, 255, alpha_}
     );
 }
 
@@ -9,13 +9,18 @@
 
 enum class TextTextureAlignment { topCenter, topLeft, topRight, bottomCenter, bottomLeft, bottomRight };
 
+// target rect of a w x h text, before it is rotated by 270 degrees around its center
+SDL_Rect textTargetRect(int w, int h, TextTextureAlignment alignment);
+
 class TextTexture
 {
 public:
-    explicit TextTexture(std::string text, TTF_Font *font, SDL_Color color, 
+    explicit TextTexture(const std::string &text, TTF_Font *font, SDL_Color color, 
         TextTextureAlignment alignment);
-    explicit TextTexture(std::string text, TTF_Font *font, SDL_Color color, 
+    explicit TextTexture(const std::string &text, TTF_Font *font, SDL_Color color, 
         TextTextureAlignment alignment, unsigned int wrapLength);
+    explicit TextTexture(const std::string &text, SDL_Surface *surface,
+        TextTextureAlignment alignment);
     virtual ~TextTexture() = default;
 
     // disallow copying and assignment
@@ -24,12 +29,13 @@ public:
 
     void updateTargetRect(TextTextureAlignment alignment);
     void render() const;
-    void render(int offsetX) const;
+    void render(float offsetX) const;
     void scrollLeft(int offset);
+    void setAlpha(Uint8 alpha) { alpha_ = alpha; }
 
     int getWidth() const { return w_; }
     int getHeight() const { return h_; }
-    std::string getText() const { return text_; }
+    const std::string &getText() const { return text_; }
     SDL_Texture * getTexture() const { return texture_.get(); }
 
 private:
@@ -37,7 +43,8 @@ private:
 
     std::string text_;
     int w_, h_;
-    SDL_Rect rect_;
+    SDL_Rect rect_; // screen rect of the texture, which is rotated by 270 degrees
+    Uint8 alpha_ = 255;
     SDLTextureUniquePtr texture_ = nullptr;
 };
 
@@ -0,0 +1,189 @@
+#include "title_cache.h"
+
+#include <iostream>
+#include <algorithm>
+#include <iterator>
+#include <SDL.h>
+
+namespace
+{
+    // requests beyond this number are dropped, oldest first,
+    // titles passed over quickly are not worth rendering anymore
+    const size_t maxRequests = 16;
+}
+
+TitleCache::TitleCache(GlyphAtlas &atlas, TTF_Font *font, TTF_Font *workerFont,
+    SDL_Color color, unsigned int wrapLength, size_t capacity, Uint32 readyEvent)
+    : atlas_(atlas), font_(font), workerFont_(workerFont), color_(color),
+      wrapLength_(wrapLength), capacity_(capacity), readyEvent_(readyEvent)
+{
+    mutex_ = SDL_CreateMutex();
+    cond_ = SDL_CreateCond();
+    // without worker font, as in scripted runs, titles are rendered on request
+    if (workerFont_ != nullptr)
+    {
+        if (mutex_ != nullptr && cond_ != nullptr)
+            thread_ = SDL_CreateThread(run, "render_titles", this);
+        if (thread_ == nullptr)
+            std::cerr << ("Title worker creation failed, titles are rendered on request") << std::endl;
+    }
+}
+
+TitleCache::~TitleCache() {
+    if (thread_ != nullptr)
+    {
+        SDL_LockMutex(mutex_);
+        isStopping_ = true;
+        SDL_CondSignal(cond_);
+        SDL_UnlockMutex(mutex_);
+        SDL_WaitThread(thread_, nullptr);
+    }
+    SDL_DestroyCond(cond_);
+    SDL_DestroyMutex(mutex_);
+}
+
+void TitleCache::request(const std::string &text) {
+    if (isReady(text))
+        return;
+
+    // without worker, render in place with the font of the main thread
+    if (thread_ == nullptr)
+    {
+        workerFont_ = font_;
+        results_.push_back(render(text));
+        processResults();
+        return;
+    }
+
+    // move the request to the front of the queue
+    SDL_LockMutex(mutex_);
+    auto found = std::find(requests_.begin(), requests_.end(), text);
+    if (found != requests_.end())
+        requests_.erase(found);
+    requests_.push_front(text);
+    if (requests_.size() > maxRequests)
+        requests_.pop_back();
+    SDL_CondSignal(cond_);
+    SDL_UnlockMutex(mutex_);
+}
+
+void TitleCache::processResults() {
+    std::vector<Result> results;
+    if (thread_ != nullptr) SDL_LockMutex(mutex_);
+    results.swap(results_);
+    if (thread_ != nullptr) SDL_UnlockMutex(mutex_);
+
+    for (auto &result : results)
+    {
+        // add glyphs of single line title to the atlas
+        for (const auto &glyph : result.glyphs)
+            atlas_.addGlyph(font_, glyph.codepoint, glyph.surface.get(), glyph.minx, glyph.advance);
+
+        // upload multiline title, and drop least recently used titles
+        if (result.surface == nullptr || textureIndex_.count(result.text) != 0)
+            continue;
+        textures_.emplace_front(result.text, std::unique_ptr<TextTexture>(new TextTexture(
+            result.text,
+            result.surface.get(),
+            TextTextureAlignment::topLeft
+        )));
+        textureIndex_[result.text] = textures_.begin();
+        while (textures_.size() > capacity_)
+        {
+            // never drop the texture currently shown
+            auto last = std::prev(textures_.end());
+            if (last->second.get() == inUse_)
+                last = std::prev(last);
+            textureIndex_.erase(last->first);
+            textures_.erase(last);
+        }
+    }
+}
+
+bool TitleCache::isReady(const std::string &text) const {
+    if (wrapLength_ == 0)
+        return atlas_.hasGlyphs(font_, text);
+    return textureIndex_.count(text) != 0;
+}
+
+TextTexture *TitleCache::getTexture(const std::string &text) {
+    auto found = textureIndex_.find(text);
+    if (found == textureIndex_.end())
+        return nullptr;
+
+    // mark as most recently used
+    textures_.splice(textures_.begin(), textures_, found->second);
+    inUse_ = textures_.front().second.get();
+    return textures_.front().second.get();
+}
+
+int TitleCache::run(void *data) {
+    auto cache = static_cast<TitleCache *>(data);
+
+    while (true)
+    {
+        // wait for the next request
+        SDL_LockMutex(cache->mutex_);
+        while (cache->requests_.empty() && !cache->isStopping_)
+            SDL_CondWait(cache->cond_, cache->mutex_);
+        if (cache->isStopping_)
+        {
+            SDL_UnlockMutex(cache->mutex_);
+            break;
+        }
+        std::string text = cache->requests_.front();
+        cache->requests_.pop_front();
+        SDL_UnlockMutex(cache->mutex_);
+
+        // render without holding the lock
+        Result result = cache->render(text);
+
+        SDL_LockMutex(cache->mutex_);
+        cache->results_.push_back(std::move(result));
+        SDL_UnlockMutex(cache->mutex_);
+
+        // notify main thread to upload the result
+        SDL_Event event;
+        SDL_zero(event);
+        event.type = cache->readyEvent_;
+        SDL_PushEvent(&event);
+    }
+
+    return 0;
+}
+
+TitleCache::Result TitleCache::render(const std::string &text) {
+    Result result;
+    result.text = text;
+
+    // multiline title is rendered as a whole
+    if (wrapLength_ != 0)
+    {
+        result.surface = SDLSurfaceUniquePtr {
+            TTF_RenderUTF8_Blended_Wrapped(workerFont_, text.c_str(), color_, wrapLength_)
+        };
+        return result;
+    }
+
+    // single line title only needs the glyphs not rendered before,
+    // in white as all glyphs in the atlas
+    size_t pos = 0;
+    while (pos < text.size())
+    {
+        Uint32 codepoint = nextCodepoint(text, pos);
+        if (!renderedGlyphs_.insert(codepoint).second)
+            continue;
+
+        Glyph glyph = {codepoint, nullptr, 0, 0};
+        int maxx = 0, miny = 0, maxy = 0;
+        TTF_GlyphMetrics32(workerFont_, codepoint, &glyph.minx, &maxx, &miny, &maxy, &glyph.advance);
+        if (codepoint != ' ')
+        {
+            glyph.surface = SDLSurfaceUniquePtr {
+                TTF_RenderGlyph32_Blended(workerFont_, codepoint, SDL_Color{255, 255, 255, 255})
+            };
+        }
+        result.glyphs.push_back(std::move(glyph));
+    }
+    return result;
+}
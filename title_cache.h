@@ -0,0 +1,93 @@
+#ifndef TITLE_CACHE_H
+#define TITLE_CACHE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+
+#include "sdl_unique_ptr.h"
+#include "text_texture.h"
+#include "glyph_atlas.h"
+
+#include <SDL_ttf.h>
+
+// Prepares titles ahead of time on a worker thread, so that showing a title
+// never waits for FreeType. The worker renders with its own instance of the
+// font, only the texture upload is left to the main thread.
+//
+// Single line titles are prefetched as glyphs into the glyph atlas, wrapped
+// multiline titles are rendered as whole surfaces and the textures made from
+// them are kept in a bounded LRU.
+class TitleCache
+{
+public:
+    // wrapLength is 0 for single line titles, readyEvent is pushed
+    // to the main thread after each title has been rendered
+    explicit TitleCache(GlyphAtlas &atlas, TTF_Font *font, TTF_Font *workerFont,
+        SDL_Color color, unsigned int wrapLength, size_t capacity, Uint32 readyEvent);
+    virtual ~TitleCache();
+
+    // disallow copying and assignment
+    TitleCache(const TitleCache &) = delete;
+    TitleCache &operator=(const TitleCache &) = delete;
+
+    // request a title, the most recent request is rendered first
+    void request(const std::string &text);
+    // upload the titles rendered by the worker, called on the main thread
+    void processResults();
+    // check if a title can be shown without rendering it
+    bool isReady(const std::string &text) const;
+    // get the prepared texture of a multiline title, nullptr if not ready,
+    // it stays valid until another texture is taken
+    TextTexture * getTexture(const std::string &text);
+
+private:
+    struct Glyph
+    {
+        Uint32 codepoint;
+        SDLSurfaceUniquePtr surface;
+        int minx, advance;
+    };
+
+    struct Result
+    {
+        std::string text;
+        SDLSurfaceUniquePtr surface; // multiline title
+        std::vector<Glyph> glyphs;   // glyphs of a single line title missing in the atlas
+    };
+
+    typedef std::list<std::pair<std::string, std::unique_ptr<TextTexture>>> TextureList;
+
+    static int run(void *data);
+    Result render(const std::string &text);
+
+    GlyphAtlas &atlas_;
+    TTF_Font *font_;        // font of the main thread, used as glyph atlas key
+    TTF_Font *workerFont_;  // font only used by the worker thread
+    SDL_Color color_;
+    unsigned int wrapLength_;
+    size_t capacity_;
+    Uint32 readyEvent_;
+
+    // state shared with the worker, guarded by mutex_
+    SDL_mutex *mutex_ = nullptr;
+    SDL_cond *cond_ = nullptr;
+    SDL_Thread *thread_ = nullptr;
+    bool isStopping_ = false;
+    std::deque<std::string> requests_;
+    std::vector<Result> results_;
+
+    // state of the worker thread only
+    std::unordered_set<Uint32> renderedGlyphs_;
+
+    // prepared textures of multiline titles, most recently used first
+    TextureList textures_;
+    std::unordered_map<std::string, TextureList::iterator> textureIndex_;
+    const TextTexture *inUse_ = nullptr; // texture last returned by getTexture
+};
+
+#endif // TITLE_CACHE_H